@@ -20,21 +20,332 @@
 #ifndef BIG_INT_HPP
 #define BIG_INT_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+    The magnitude of a BigInt is stored in base 2^64: each 64-bit `big_limb` is
+    one "digit", and the limbs are kept least significant first. A
+    `big_double_limb` holds the full product of two limbs.
+*/
+
+using big_limb = std::uint64_t;
+using big_double_limb = unsigned __int128;
+
+
+/*
+    big_int_memory_resource
+    -----------------------
+    The memory resource that BigInts created on this thread take their heap
+    buffers from, or null for the global `new` and `delete`. It is set for a
+    scope with `BigIntMemoryScope`.
+*/
+
+thread_local std::pmr::memory_resource* big_int_memory_resource = nullptr;
+
+
+/*
+    BigIntMemoryScope
+    -----------------
+    Makes `resource` the memory resource of the BigInts created on this thread
+    until the end of the scope, so that a computation can run, for instance,
+    inside a `std::pmr::monotonic_buffer_resource` arena or on a per-thread
+    `std::pmr::unsynchronized_pool_resource`. Scopes can be nested.
+    NOTE: the BigInts created in the scope must not outlive the resource.
+    Assigning one to a BigInt created outside the scope copies the value out,
+    while returning it from a function moves the buffer along.
+*/
+
+class BigIntMemoryScope {
+    std::pmr::memory_resource* previous;
+
+    public:
+        explicit BigIntMemoryScope(std::pmr::memory_resource* resource)
+                : previous(big_int_memory_resource) {
+            big_int_memory_resource = resource;
+        }
+
+        ~BigIntMemoryScope() {
+            big_int_memory_resource = previous;
+        }
+
+        BigIntMemoryScope(const BigIntMemoryScope&) = delete;
+        BigIntMemoryScope& operator=(const BigIntMemoryScope&) = delete;
+};
+
+
+/*
+    BigIntLimbs
+    -----------
+    The limb array of a BigInt. It behaves like a `std::vector<big_limb>`, but
+    up to `INLINE_CAPACITY` limbs (128 bits) are stored in the object itself,
+    so small values such as loop counters and constants never touch the heap.
+    The limbs move to a heap buffer only when a value outgrows them.
+
+    The heap buffers come from the memory resource that was current when the
+    limbs were created, as with `std::pmr::vector`: moving from limbs with a
+    different resource copies the values instead of taking the buffer over.
+*/
+
+class BigIntLimbs {
+    static const size_t INLINE_CAPACITY = 2;
+
+    big_limb* limbs;        // `inline_limbs` or a heap buffer
+    size_t count;
+    size_t capacity;
+    std::pmr::memory_resource* resource;    // null for `new` and `delete`
+    big_limb inline_limbs[INLINE_CAPACITY];
+
+    bool is_inline() const {
+        return limbs == inline_limbs;
+    }
+
+    big_limb* allocate(size_t n) {
+        if (resource == nullptr)
+            return new big_limb[n];
+        return static_cast<big_limb*>(resource->allocate(n * sizeof(big_limb), alignof(big_limb)));
+    }
+
+    void deallocate(big_limb* buffer, size_t n) {
+        if (resource == nullptr)
+            delete[] buffer;
+        else
+            resource->deallocate(buffer, n * sizeof(big_limb), alignof(big_limb));
+    }
+
+    // Moves the limbs of `other`, which must either keep them inline or share
+    // our memory resource, so that nothing is allocated: inline limbs fit in
+    // any buffer and are copied, while a heap buffer is taken over.
+    void take(BigIntLimbs& other) noexcept {
+        if (other.is_inline())
+            std::copy(other.begin(), other.end(), limbs);
+        else {
+            if (!is_inline())
+                deallocate(limbs, capacity);
+            limbs = other.limbs;
+            capacity = other.capacity;
+            other.limbs = other.inline_limbs;
+            other.capacity = INLINE_CAPACITY;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+    public:
+        BigIntLimbs() : limbs(inline_limbs), count(0), capacity(INLINE_CAPACITY),
+                        resource(big_int_memory_resource) {}
+
+        BigIntLimbs(const BigIntLimbs& other) : BigIntLimbs() {
+            assign(other.begin(), other.end());
+        }
+
+        // The buffer is taken over together with its memory resource.
+        BigIntLimbs(BigIntLimbs&& other) noexcept : BigIntLimbs() {
+            resource = other.resource;
+            take(other);
+        }
+
+        ~BigIntLimbs() {
+            if (!is_inline())
+                deallocate(limbs, capacity);
+        }
+
+        BigIntLimbs& operator=(const BigIntLimbs& other) {
+            if (this != &other)
+                assign(other.begin(), other.end());
+
+            return *this;
+        }
+
+        // Not noexcept: a heap buffer from another memory resource is copied,
+        // and the copy may need a buffer of our own.
+        BigIntLimbs& operator=(BigIntLimbs&& other) {
+            if (this == &other)
+                return *this;
+            if (!other.is_inline() and other.resource != resource) {
+                assign(other.begin(), other.end());
+                other.count = 0;
+            }
+            else
+                take(other);
+
+            return *this;
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        big_limb* data() { return limbs; }
+        const big_limb* data() const { return limbs; }
+        big_limb* begin() { return limbs; }
+        const big_limb* begin() const { return limbs; }
+        big_limb* end() { return limbs + count; }
+        const big_limb* end() const { return limbs + count; }
+        big_limb& operator[](size_t i) { return limbs[i]; }
+        const big_limb& operator[](size_t i) const { return limbs[i]; }
+        big_limb& back() { return limbs[count - 1]; }
+        const big_limb& back() const { return limbs[count - 1]; }
+
+        // Keeps the current limbs.
+        void reserve(size_t new_capacity) {
+            if (new_capacity <= capacity)
+                return;
+
+            big_limb* buffer = allocate(new_capacity);
+            std::copy(begin(), end(), buffer);
+            if (!is_inline())
+                deallocate(limbs, capacity);
+            limbs = buffer;
+            capacity = new_capacity;
+        }
+
+        // New limbs are set to `value`, as with `std::vector`.
+        void resize(size_t new_count, big_limb value = 0) {
+            if (new_count > capacity)
+                reserve(std::max(new_count, 2 * capacity));
+            if (new_count > count)
+                std::fill(limbs + count, limbs + new_count, value);
+            count = new_count;
+        }
+
+        void assign(size_t new_count, big_limb value) {
+            count = 0;
+            resize(new_count, value);
+        }
+
+        // The range may not lie within these limbs.
+        void assign(const big_limb* first, const big_limb* last) {
+            size_t new_count = last - first;
+            count = 0;
+            reserve(new_count);
+            std::copy(first, last, limbs);
+            count = new_count;
+        }
+
+        void push_back(big_limb limb) {
+            if (count == capacity)
+                reserve(2 * capacity);
+            limbs[count++] = limb;
+        }
+
+        void pop_back() { count--; }
+        void clear() { count = 0; }
+
+        bool operator==(const BigIntLimbs& other) const {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+};
+
+
+/*
+    BigIntConstant
+    --------------
+    A fixed-capacity integer of up to `N` limbs that can be built entirely in
+    constant expressions, so that constants and precomputed tables are laid
+    out by the compiler instead of being parsed or computed at startup. It
+    only knows how to be built: a BigInt is made from it by copying its limbs.
+*/
+
+template <size_t N>
+struct BigIntConstant {
+    big_limb limbs[N] = {};
+    size_t size = 0;            // limbs in use, no high-order zero limbs
+    bool negative = false;
+
+    constexpr BigIntConstant() = default;
+
+    constexpr BigIntConstant(long long num) : negative(num < 0) {
+        // negate in unsigned arithmetic so that LLONG_MIN does not overflow
+        big_limb magnitude = num < 0 ? 0 - (big_limb) num : (big_limb) num;
+        if (magnitude != 0)
+            limbs[size++] = magnitude;
+    }
+
+    // Sets the magnitude to magnitude * multiplier + addend.
+    constexpr void mul_add(big_limb multiplier, big_limb addend) {
+        big_limb carry = addend;
+        for (size_t i = 0; i < size; i++) {
+            big_double_limb product = (big_double_limb) limbs[i] * multiplier + carry;
+            limbs[i] = (big_limb) product;
+            carry = (big_limb) (product >> 64);
+        }
+        if (carry != 0) {
+            if (size == N)
+                throw std::overflow_error("BigIntConstant capacity exceeded");
+            limbs[size++] = carry;
+        }
+        if (size == 0)
+            negative = false;
+    }
+
+    // Parses an optional sign and digits in base 10, or in base 16, 8 or 2
+    // after a "0x", "0" or "0b" prefix as in C++ literals, which may be
+    // separated with apostrophes.
+    static constexpr BigIntConstant from_string(std::string_view text) {
+        BigIntConstant num;
+        bool negative = false;
+        if (not text.empty() and (text[0] == '+' or text[0] == '-')) {
+            negative = text[0] == '-';
+            text.remove_prefix(1);
+        }
+
+        big_limb base = 10;
+        if (text.size() > 2 and text[0] == '0' and (text[1] == 'x' or text[1] == 'X')) {
+            base = 16;
+            text.remove_prefix(2);
+        }
+        else if (text.size() > 2 and text[0] == '0' and (text[1] == 'b' or text[1] == 'B')) {
+            base = 2;
+            text.remove_prefix(2);
+        }
+        else if (text.size() > 1 and text[0] == '0')
+            base = 8;
+
+        if (text.empty())
+            throw std::invalid_argument("Expected an integer");
+        for (char c : text) {
+            if (c == '\'')
+                continue;
+            big_limb digit = c >= '0' and c <= '9' ? c - '0'
+                           : c >= 'a' and c <= 'f' ? c - 'a' + 10
+                           : c >= 'A' and c <= 'F' ? c - 'A' + 10
+                           : base;
+            if (digit >= base)
+                throw std::invalid_argument("Expected an integer");
+            num.mul_add(base, digit);
+        }
+        num.negative = negative and num.size != 0;
+
+        return num;
+    }
+};
+
 
 class BigInt {
-    std::string value;
+    BigIntLimbs limbs;      // magnitude, no high-order zero limbs
     char sign;
 
     public:
         // Constructors:
         BigInt();
         BigInt(const BigInt&);
+        BigInt(BigInt&&) noexcept;
         BigInt(const long long&);
         BigInt(const std::string&);
+        template <size_t N>
+        BigInt(const BigIntConstant<N>&);
 
         // Assignment operators:
         BigInt& operator=(const BigInt&);
+        BigInt& operator=(BigInt&&);
         BigInt& operator=(const long long&);
         BigInt& operator=(const std::string&);
 
@@ -43,22 +354,36 @@ class BigInt {
         BigInt operator-() const;   // unary -
 
         // Binary arithmetic operators:
-        BigInt operator+(const BigInt&) const;
-        BigInt operator-(const BigInt&) const;
-        BigInt operator*(const BigInt&) const;
+        BigInt operator+(const BigInt&) const&;
+        BigInt operator-(const BigInt&) const&;
+        BigInt operator*(const BigInt&) const&;
         BigInt operator/(const BigInt&) const;
         BigInt operator%(const BigInt&) const;
-        BigInt operator+(const long long&) const;
-        BigInt operator-(const long long&) const;
-        BigInt operator*(const long long&) const;
+        BigInt operator+(const long long&) const&;
+        BigInt operator-(const long long&) const&;
+        BigInt operator*(const long long&) const&;
         BigInt operator/(const long long&) const;
         BigInt operator%(const long long&) const;
-        BigInt operator+(const std::string&) const;
-        BigInt operator-(const std::string&) const;
-        BigInt operator*(const std::string&) const;
+        BigInt operator+(const std::string&) const&;
+        BigInt operator-(const std::string&) const&;
+        BigInt operator*(const std::string&) const&;
         BigInt operator/(const std::string&) const;
         BigInt operator%(const std::string&) const;
 
+        // Squaring:
+        BigInt square() const;
+
+        // Binary arithmetic operators reusing the storage of a temporary LHS:
+        BigInt operator+(const BigInt&) &&;
+        BigInt operator-(const BigInt&) &&;
+        BigInt operator*(const BigInt&) &&;
+        BigInt operator+(const long long&) &&;
+        BigInt operator-(const long long&) &&;
+        BigInt operator*(const long long&) &&;
+        BigInt operator+(const std::string&) &&;
+        BigInt operator-(const std::string&) &&;
+        BigInt operator*(const std::string&) &&;
+
         // Arithmetic-assignment operators:
         BigInt& operator+=(const BigInt&);
         BigInt& operator-=(const BigInt&);
@@ -76,6 +401,30 @@ class BigInt {
         BigInt& operator/=(const std::string&);
         BigInt& operator%=(const std::string&);
 
+        // Fused multiply-add and multiply-subtract:
+        BigInt& add_product(const BigInt&, const BigInt&);
+        BigInt& sub_product(const BigInt&, const BigInt&);
+        BigInt& add_product(const BigInt&, const long long&);
+        BigInt& sub_product(const BigInt&, const long long&);
+
+        // Bitwise operators, with the semantics of two's complement:
+        BigInt operator~() const;
+        BigInt operator&(const BigInt&) const;
+        BigInt operator|(const BigInt&) const;
+        BigInt operator^(const BigInt&) const;
+        BigInt operator<<(size_t) const;
+        BigInt operator>>(size_t) const;
+        BigInt& operator&=(const BigInt&);
+        BigInt& operator|=(const BigInt&);
+        BigInt& operator^=(const BigInt&);
+        BigInt& operator<<=(size_t);
+        BigInt& operator>>=(size_t);
+
+        // Bit counts of the absolute value:
+        size_t bit_length() const;
+        size_t popcount() const;
+        size_t countr_zero() const;
+
         // Increment and decrement operators:
         BigInt& operator++();       // pre-increment
         BigInt& operator--();       // pre-decrement
@@ -108,12 +457,55 @@ class BigInt {
 
         // Conversion functions:
         std::string to_string() const;
+        template <typename Start, typename Write>
+        friend void write_digits(const BigInt&, int, bool, Start, Write);
         int to_int() const;
         long to_long() const;
         long long to_long_long() const;
 
-        // Random number generating functions:
-        friend BigInt big_random(size_t);
+        // Random generation:
+        template <typename URBG>
+        friend BigInt big_random_bits(size_t, URBG&);
+
+        // Binary serialization:
+        static const size_t BYTES_HEADER_SIZE = 8;
+        size_t byte_size() const;
+        static size_t byte_size(std::span<const std::byte>);
+        size_t to_bytes(std::span<std::byte>) const;
+        static BigInt from_bytes(std::span<const std::byte>);
+
+        // Signed addition helper:
+        friend void add_signed(BigInt&, const BigInt&, const BigInt&, char);
+        friend void add_product_signed(BigInt&, const BigInt&, const BigInt&, char);
+
+        // Division with remainder:
+        friend std::tuple<BigInt, BigInt> divmod(const BigInt&, const BigInt&);
+
+        // Integer square root:
+        friend BigInt sqrt(const BigInt&);
+
+        // Greatest common divisor:
+        friend BigInt gcd(const BigInt&, const BigInt&);
+        friend std::tuple<BigInt, BigInt, BigInt> gcd_extended(const BigInt&, const BigInt&);
+
+        // Modular exponentiation:
+        friend class BigIntMontgomery;
+        friend class BigIntBarrett;
+        friend BigInt powmod(const BigInt&, const BigInt&, const BigInt&);
+
+        // Word-sized kernels for the operators with an integer operand:
+        friend BigInt big_from_word(big_limb);
+        friend int compare_word(const BigInt&, long long);
+        friend void add_word(BigInt&, const BigInt&, big_limb, char);
+        friend void mul_word(BigInt&, const BigInt&, big_limb, char);
+        friend void add_product_word(BigInt&, const BigInt&, big_limb, char);
+
+        // Bitwise kernels:
+        friend void bitwise_signed(BigInt&, const BigInt&, const BigInt&, char);
+        friend void lshift_signed(BigInt&, const BigInt&, size_t);
+        friend void rshift_signed(BigInt&, const BigInt&, size_t);
+        friend big_limb divmod_word(BigInt&, const BigInt&, big_limb);
+        friend big_limb mod_word(const BigInt&, big_limb);
 };
 
 #endif  // BIG_INT_HPP
@@ -128,7 +520,6 @@ class BigInt {
 #ifndef BIG_INT_UTILITY_FUNCTIONS_HPP
 #define BIG_INT_UTILITY_FUNCTIONS_HPP
 
-#include <tuple>
 
 
 /*
@@ -149,974 +540,4218 @@ bool is_valid_number(const std::string& num) {
 /*
     strip_leading_zeroes
     --------------------
-    Strip the leading zeroes from a number represented as a string.
+    Strip the high-order zero limbs from a limb-represented magnitude, held
+    either by a BigInt or in a `std::vector`.
 */
 
-void strip_leading_zeroes(std::string& num) {
-    size_t i;
-    for (i = 0; i < num.size(); i++)
-        if (num[i] != '0')
-            break;
-
-    if (i == num.size())
-        num = "0";
-    else
-        num = num.substr(i);
+template <typename Limbs>
+void strip_leading_zeroes(Limbs& num) {
+    while (!num.empty() and num.back() == 0)
+        num.pop_back();
 }
 
 
 /*
-    add_leading_zeroes
-    ------------------
-    Adds a given number of leading zeroes to a string-represented integer `num`.
+    word_magnitude
+    --------------
+    Returns the absolute value of an integer as a limb. The negation is done in
+    unsigned arithmetic, so that LLONG_MIN does not overflow.
 */
 
-void add_leading_zeroes(std::string& num, size_t num_zeroes) {
-    num = std::string(num_zeroes, '0') + num;
+big_limb word_magnitude(long long num) {
+    return num < 0 ? 0 - (big_limb) num : (big_limb) num;
 }
 
 
 /*
-    add_trailing_zeroes
-    -------------------
-    Adds a given number of trailing zeroes to a string-represented integer `num`.
+    assign_double_limb
+    ------------------
+    Set a limb-represented magnitude to a value of up to two limbs.
 */
 
-void add_trailing_zeroes(std::string& num, size_t num_zeroes) {
-    num += std::string(num_zeroes, '0');
+void assign_double_limb(BigIntLimbs& num, big_double_limb value) {
+    num.clear();
+    if (value != 0)
+        num.push_back((big_limb) value);
+    if ((value >> 64) != 0)
+        num.push_back((big_limb) (value >> 64));
 }
 
+#endif  // BIG_INT_UTILITY_FUNCTIONS_HPP
+
 
 /*
-    get_larger_and_smaller
-    ----------------------
-    Identifies the given string-represented integers as `larger` and `smaller`,
-    padding the smaller number with leading zeroes to make it equal in length to
-    the larger number.
+    ===========================================================================
+    Limb arithmetic functions
+    ===========================================================================
+    Low-level routines that operate on raw little-endian limb arrays. Unless
+    stated otherwise, the result `r` may be the same array as the first operand
+    but must not partially overlap any operand.
 */
 
-std::tuple<std::string, std::string> get_larger_and_smaller(const std::string& num1,
-        const std::string& num2) {
-    std::string larger, smaller;
-    if (num1.size() > num2.size() or
-        (num1.size() == num2.size() and num1 > num2)) {
-        larger = num1;
-        smaller = num2;
-    }
-    else {
-        larger = num2;
-        smaller = num1;
-    }
-
-    // pad the smaller number with zeroes
-    add_leading_zeroes(smaller, larger.size() - smaller.size());
+#ifndef BIG_INT_LIMB_FUNCTIONS_HPP
+#define BIG_INT_LIMB_FUNCTIONS_HPP
 
-    return std::make_tuple(larger, smaller);
-}
+#include <bit>
+#include <cstddef>
 
 
 /*
-    is_power_of_10
-    ----------------------
-    Checks whether a string-represented integer is a power of 10.
+    compare_limbs
+    -------------
+    Compares two stripped magnitudes. Returns a negative number, zero or a
+    positive number when `a` is less than, equal to or greater than `b`.
 */
 
-bool is_power_of_10(const std::string& num){
-    if (num[0] != '1')
-        return false;
-    for (size_t i = 1; i < num.size(); i++)
-        if (num[i] != '0')
-            return false;
+int compare_limbs(const big_limb* a, size_t na, const big_limb* b, size_t nb) {
+    if (na != nb)
+        return na < nb ? -1 : 1;
+    while (na-- > 0)
+        if (a[na] != b[na])
+            return a[na] < b[na] ? -1 : 1;
 
-    return true;    // first digit is 1 and the following digits are all 0
+    return 0;
 }
 
-#endif  // BIG_INT_UTILITY_FUNCTIONS_HPP
-
 
 /*
-    ===========================================================================
-    Random number generating functions for BigInt
-    ===========================================================================
+    add_n / sub_n kernels
+    ---------------------
+    Compute r = a + b or r = a - b over `n` limbs with an incoming carry or
+    borrow of 0 or 1, and return the carry or borrow out. The scalar kernels
+    work on any machine. On x86-64, the SSE4.1 and AVX2 kernels add 2 or 4
+    limbs per step: the lanes are added without carries, the carry out of each
+    lane is read from the top bits of the operands and the sum, and the
+    carries are then rippled across the lanes with one scalar addition of
+    bitmasks, where lanes that are all ones (all zeroes for subtraction) pass
+    an incoming carry on.
 */
 
-#ifndef BIG_INT_RANDOM_FUNCTIONS_HPP
-#define BIG_INT_RANDOM_FUNCTIONS_HPP
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define BIG_INT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+big_limb add_n_scalar(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb carry) {
+    for (size_t i = 0; i < n; i++) {
+        big_limb sum = a[i] + carry;
+        carry = sum < carry;
+        sum += b[i];
+        carry += sum < b[i];
+        r[i] = sum;
+    }
 
-#include <random>
-#include <climits>
+    return carry;
+}
 
+big_limb sub_n_scalar(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb borrow) {
+    for (size_t i = 0; i < n; i++) {
+        big_limb diff = a[i] - b[i];
+        big_limb next_borrow = a[i] < b[i];
+        next_borrow += diff < borrow;
+        r[i] = diff - borrow;
+        borrow = next_borrow;
+    }
 
-// when the number of digits are not specified, a random value is used for it
-// which is kept below the following:
-const size_t MAX_RANDOM_LENGTH = 1000;
+    return borrow;
+}
 
+#ifdef BIG_INT_X86_KERNELS
+
+__attribute__((target("sse4.1")))
+big_limb add_n_sse41(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb carry) {
+    const __m128i ones = _mm_set1_epi64x(-1);
+    const __m128i lane_bits = _mm_set_epi64x(2, 1);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*) (b + i));
+        __m128i sum = _mm_add_epi64(x, y);
+
+        // the top bit of (x & y) | ((x | y) & ~sum) is the carry out of a lane
+        __m128i generate = _mm_or_si128(_mm_and_si128(x, y),
+                                        _mm_andnot_si128(sum, _mm_or_si128(x, y)));
+        unsigned g = _mm_movemask_pd(_mm_castsi128_pd(generate));
+        unsigned p = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(sum, ones)));
+        unsigned carries = ((g << 1) | (unsigned) carry) + p;
+        unsigned carry_in = (carries ^ p) & 3;
+        carry = carries >> 2;
+
+        // subtracting -1 adds the incoming carry to the lanes that get one
+        __m128i in_lanes = _mm_cmpeq_epi64(
+            _mm_and_si128(_mm_set1_epi64x(carry_in), lane_bits), lane_bits);
+        _mm_storeu_si128((__m128i*) (r + i), _mm_sub_epi64(sum, in_lanes));
+    }
 
-/*
-    big_random (num_digits)
-    -----------------------
-    Returns a random BigInt with a specific number of digits.
-*/
+    return add_n_scalar(r + i, a + i, b + i, n - i, carry);
+}
 
-BigInt big_random(size_t num_digits = 0) {
-    std::random_device rand_generator;      // true random number generator
+__attribute__((target("sse4.1")))
+big_limb sub_n_sse41(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb borrow) {
+    const __m128i zeroes = _mm_setzero_si128();
+    const __m128i lane_bits = _mm_set_epi64x(2, 1);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*) (b + i));
+        __m128i diff = _mm_sub_epi64(x, y);
+
+        // the top bit of (~x & y) | (~(x ^ y) & diff) is the borrow out of a lane
+        __m128i generate = _mm_or_si128(_mm_andnot_si128(x, y),
+                                        _mm_andnot_si128(_mm_xor_si128(x, y), diff));
+        unsigned g = _mm_movemask_pd(_mm_castsi128_pd(generate));
+        unsigned p = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(diff, zeroes)));
+        unsigned borrows = ((g << 1) | (unsigned) borrow) + p;
+        unsigned borrow_in = (borrows ^ p) & 3;
+        borrow = borrows >> 2;
+
+        __m128i in_lanes = _mm_cmpeq_epi64(
+            _mm_and_si128(_mm_set1_epi64x(borrow_in), lane_bits), lane_bits);
+        _mm_storeu_si128((__m128i*) (r + i), _mm_add_epi64(diff, in_lanes));
+    }
 
-    if (num_digits == 0)    // the number of digits were not specified
-        // use a random number for it:
-        num_digits = 1 + rand_generator() % MAX_RANDOM_LENGTH;
+    return sub_n_scalar(r + i, a + i, b + i, n - i, borrow);
+}
 
-    BigInt big_rand;
-    big_rand.value = "";    // clear value to append digits
+__attribute__((target("avx2")))
+big_limb add_n_avx2(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb carry) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i sum = _mm256_add_epi64(x, y);
+
+        __m256i generate = _mm256_or_si256(_mm256_and_si256(x, y),
+                                           _mm256_andnot_si256(sum, _mm256_or_si256(x, y)));
+        unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(generate));
+        unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(sum, ones)));
+        unsigned carries = ((g << 1) | (unsigned) carry) + p;
+        unsigned carry_in = (carries ^ p) & 15;
+        carry = carries >> 4;
+
+        __m256i in_lanes = _mm256_cmpeq_epi64(
+            _mm256_and_si256(_mm256_set1_epi64x(carry_in), lane_bits), lane_bits);
+        _mm256_storeu_si256((__m256i*) (r + i), _mm256_sub_epi64(sum, in_lanes));
+    }
 
-    // ensure that the first digit is non-zero
-    big_rand.value += std::to_string(1 + rand_generator() % 9);
+    return add_n_scalar(r + i, a + i, b + i, n - i, carry);
+}
 
-    while (big_rand.value.size() < num_digits)
-        big_rand.value += std::to_string(rand_generator());
-    if (big_rand.value.size() != num_digits)
-        big_rand.value.erase(num_digits);   // erase extra digits
+__attribute__((target("avx2")))
+big_limb sub_n_avx2(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        big_limb borrow) {
+    const __m256i zeroes = _mm256_setzero_si256();
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i diff = _mm256_sub_epi64(x, y);
+
+        __m256i generate = _mm256_or_si256(_mm256_andnot_si256(x, y),
+                                           _mm256_andnot_si256(_mm256_xor_si256(x, y), diff));
+        unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(generate));
+        unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(diff, zeroes)));
+        unsigned borrows = ((g << 1) | (unsigned) borrow) + p;
+        unsigned borrow_in = (borrows ^ p) & 15;
+        borrow = borrows >> 4;
+
+        __m256i in_lanes = _mm256_cmpeq_epi64(
+            _mm256_and_si256(_mm256_set1_epi64x(borrow_in), lane_bits), lane_bits);
+        _mm256_storeu_si256((__m256i*) (r + i), _mm256_add_epi64(diff, in_lanes));
+    }
 
-    return big_rand;
+    return sub_n_scalar(r + i, a + i, b + i, n - i, borrow);
 }
 
-
-#endif  // BIG_INT_RANDOM_FUNCTIONS_HPP
+#endif  // BIG_INT_X86_KERNELS
 
 
 /*
-    ===========================================================================
-    Constructors
-    ===========================================================================
+    BigIntLimbKernels
+    -----------------
+    The add_n and sub_n kernels in use, chosen once from what the CPU reports
+    through CPUID. `name` is "avx2", "sse4.1" or "scalar".
 */
 
-#ifndef BIG_INT_CONSTRUCTORS_HPP
-#define BIG_INT_CONSTRUCTORS_HPP
-
+using big_limb_kernel = big_limb (*)(big_limb*, const big_limb*, const big_limb*, size_t, big_limb);
 
+struct BigIntLimbKernels {
+    big_limb_kernel add_n;
+    big_limb_kernel sub_n;
+    const char* name;
+};
 
-/*
-    Default constructor
-    -------------------
-*/
-
-BigInt::BigInt() {
-    value = "0";
-    sign = '+';
+const BigIntLimbKernels& limb_kernels() {
+    static const BigIntLimbKernels kernels = [] {
+#ifdef BIG_INT_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return BigIntLimbKernels{add_n_avx2, sub_n_avx2, "avx2"};
+        if (__builtin_cpu_supports("sse4.1"))
+            return BigIntLimbKernels{add_n_sse41, sub_n_sse41, "sse4.1"};
+#endif
+        return BigIntLimbKernels{add_n_scalar, sub_n_scalar, "scalar"};
+    }();
+
+    return kernels;
 }
 
+// below this many limbs the scalar loops are used without dispatching
+inline constexpr size_t LIMB_KERNEL_MIN_SIZE = 8;
+
 
 /*
-    Copy constructor
-    ----------------
+    add_limbs
+    ---------
+    Computes r = a + b, where `na` >= `nb`, and returns the carry out of the
+    `na` limbs of `r`.
 */
 
-BigInt::BigInt(const BigInt& num) {
-    value = num.value;
-    sign = num.sign;
+big_limb add_limbs(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb) {
+    big_limb carry = nb < LIMB_KERNEL_MIN_SIZE ? add_n_scalar(r, a, b, nb, 0)
+                                               : limb_kernels().add_n(r, a, b, nb, 0);
+    for (size_t i = nb; i < na; i++) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+
+    return carry;
 }
 
 
 /*
-    Integer to BigInt
-    -----------------
+    add_limb
+    --------
+    Computes r = a + m over `n` limbs and returns the carry out of them.
 */
 
-BigInt::BigInt(const long long& num) {
-    value = std::to_string(std::abs(num));
-    if (num < 0)
-        sign = '-';
-    else
-        sign = '+';
+big_limb add_limb(big_limb* r, const big_limb* a, size_t n, big_limb m) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] + m;
+        m = r[i] < m;
+    }
+
+    return m;
 }
 
 
 /*
-    String to BigInt
-    ----------------
+    increment_limbs / decrement_limbs
+    ---------------------------------
+    Add or subtract one in place, stopping as soon as the carry or borrow is
+    absorbed, and return the carry or borrow out of the `n` limbs.
 */
 
-BigInt::BigInt(const std::string& num) {
-    if (num[0] == '+' or num[0] == '-') {     // check for sign
-        std::string magnitude = num.substr(1);
-        if (is_valid_number(magnitude)) {
-            value = magnitude;
-            sign = num[0];
-        }
-        else {
-            throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
-        }
-    }
-    else {      // if no sign is specified
-        if (is_valid_number(num)) {
-            value = num;
-            sign = '+';    // positive by default
-        }
-        else {
-            throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
-        }
-    }
-    strip_leading_zeroes(value);
+big_limb increment_limbs(big_limb* a, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (++a[i] != 0)
+            return 0;
+
+    return 1;
 }
 
-#endif  // BIG_INT_CONSTRUCTORS_HPP
+big_limb decrement_limbs(big_limb* a, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (a[i]-- != 0)
+            return 0;
+
+    return 1;
+}
 
 
 /*
-    ===========================================================================
-    Conversion functions for BigInt
-    ===========================================================================
+    negate_limbs
+    ------------
+    Replaces the `n` limbs of `a` with their two's complement, which turns
+    the result of a subtraction that borrowed out of the top limb into the
+    magnitude of the difference.
 */
 
-#ifndef BIG_INT_CONVERSION_FUNCTIONS_HPP
-#define BIG_INT_CONVERSION_FUNCTIONS_HPP
+void negate_limbs(big_limb* a, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        a[i] = ~a[i];
+    increment_limbs(a, n);
+}
 
 
 /*
-    to_string
+    sub_limbs
     ---------
-    Converts a BigInt to a string.
+    Computes r = a - b, where `na` >= `nb`, and returns the borrow out of the
+    `na` limbs of `r`.
 */
 
-std::string BigInt::to_string() const {
-    // prefix with sign if negative
-    return this->sign == '-' ? "-" + this->value : this->value;
+big_limb sub_limbs(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb) {
+    big_limb borrow = nb < LIMB_KERNEL_MIN_SIZE ? sub_n_scalar(r, a, b, nb, 0)
+                                                : limb_kernels().sub_n(r, a, b, nb, 0);
+    for (size_t i = nb; i < na; i++) {
+        big_limb limb = a[i];
+        r[i] = limb - borrow;
+        borrow = limb < borrow;
+    }
+
+    return borrow;
 }
 
 
 /*
-    to_int
-    ------
-    Converts a BigInt to an int.
-    NOTE: If the BigInt is out of range of an int, stoi() will throw an
-    out_of_range exception.
+    mul_limb
+    --------
+    Computes r = a * m over `n` limbs and returns the high limb of the product.
 */
 
-int BigInt::to_int() const {
-    return std::stoi(this->to_string());
+big_limb mul_limb(big_limb* r, const big_limb* a, size_t n, big_limb m) {
+    big_limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_double_limb product = (big_double_limb) a[i] * m + carry;
+        r[i] = (big_limb) product;
+        carry = (big_limb) (product >> 64);
+    }
+
+    return carry;
 }
 
 
 /*
-    to_long
-    -------
-    Converts a BigInt to a long int.
-    NOTE: If the BigInt is out of range of a long int, stol() will throw an
-    out_of_range exception.
+    addmul_limb
+    -----------
+    Computes r += a * m over `n` limbs and returns the carry out of them.
+    `r` must not overlap `a`.
 */
 
-long BigInt::to_long() const {
-    return std::stol(this->to_string());
+big_limb addmul_limb(big_limb* r, const big_limb* a, size_t n, big_limb m) {
+    big_limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_double_limb product = (big_double_limb) a[i] * m + r[i] + carry;
+        r[i] = (big_limb) product;
+        carry = (big_limb) (product >> 64);
+    }
+
+    return carry;
 }
 
 
 /*
-    to_long_long
-    ------------
-    Converts a BigInt to a long long int.
-    NOTE: If the BigInt is out of range of a long long int, stoll() will throw
-    an out_of_range exception.
+    submul_limb
+    -----------
+    Computes r -= a * m over `n` limbs and returns the borrow out of them.
+    `r` must not overlap `a`.
 */
 
-long long BigInt::to_long_long() const {
-    return std::stoll(this->to_string());
-}
+big_limb submul_limb(big_limb* r, const big_limb* a, size_t n, big_limb m) {
+    big_limb borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_double_limb product = (big_double_limb) a[i] * m + borrow;
+        big_limb low = (big_limb) product;
+        borrow = (big_limb) (product >> 64) + (r[i] < low);
+        r[i] -= low;
+    }
 
-#endif  // BIG_INT_CONVERSION_FUNCTIONS_HPP
+    return borrow;
+}
 
 
 /*
-    ===========================================================================
-    Assignment operators
-    ===========================================================================
+    mul_limbs_basecase
+    ------------------
+    Computes the `na` + `nb` limbs of r = a * b using long multiplication.
+    `r` must not overlap either operand.
 */
 
-#ifndef BIG_INT_ASSIGNMENT_OPERATORS_HPP
-#define BIG_INT_ASSIGNMENT_OPERATORS_HPP
-
+void mul_limbs_basecase(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb) {
+    r[na] = mul_limb(r, a, na, b[0]);
+    for (size_t i = 1; i < nb; i++)
+        r[na + i] = addmul_limb(r + i, a, na, b[i]);
+}
 
 
 /*
-    BigInt = BigInt
+    reciprocal_limb
     ---------------
+    Returns the reciprocal v = floor((2^128 - 1) / d) - 2^64 of a normalized
+    limb `d` (one with its top bit set), for use with `div_2by1`.
 */
 
-BigInt& BigInt::operator=(const BigInt& num) {
-    value = num.value;
-    sign = num.sign;
-
-    return *this;
+big_limb reciprocal_limb(big_limb d) {
+    return (big_limb) ((((big_double_limb) ~d) << 64 | ~(big_limb) 0) / d);
 }
 
 
 /*
-    BigInt = Integer
-    ----------------
+    div_2by1
+    --------
+    Divides the two-limb number (u1, u0) by the normalized limb `d`, where
+    u1 < d, using the precomputed reciprocal `v` of `d` (Möller and
+    Granlund's algorithm). Returns the quotient and sets `remainder`. This
+    replaces a slow 128-by-64-bit division with two multiplications.
 */
 
-BigInt& BigInt::operator=(const long long& num) {
-    BigInt temp(num);
-    value = temp.value;
-    sign = temp.sign;
+big_limb div_2by1(big_limb& remainder, big_limb u1, big_limb u0, big_limb d, big_limb v) {
+    big_double_limb q = (big_double_limb) v * u1 + (((big_double_limb) u1 << 64) | u0);
+    big_limb q1 = (big_limb) (q >> 64) + 1, q0 = (big_limb) q;
+    big_limb r = u0 - q1 * d;
+    if (r > q0) {
+        q1--;
+        r += d;
+    }
+    if (r >= d) {
+        q1++;
+        r -= d;
+    }
+    remainder = r;
 
-    return *this;
+    return q1;
 }
 
 
 /*
-    BigInt = String
-    ---------------
+    divmod_limb
+    -----------
+    Computes q = a / d over `n` limbs and returns the remainder. The divisor
+    is normalized so that each step can use `div_2by1`.
 */
 
-BigInt& BigInt::operator=(const std::string& num) {
-    BigInt temp(num);
-    value = temp.value;
-    sign = temp.sign;
+big_limb divmod_limb(big_limb* q, const big_limb* a, size_t n, big_limb d) {
+    unsigned shift = std::countl_zero(d);
+    d <<= shift;
+    big_limb v = reciprocal_limb(d);
 
-    return *this;
+    big_limb remainder = 0;
+    if (shift == 0) {
+        while (n-- > 0)
+            q[n] = div_2by1(remainder, remainder, a[n], d, v);
+        return remainder;
+    }
+
+    // divide a * 2^shift, feeding its limbs in as they are shifted
+    if (n > 0)
+        remainder = a[n - 1] >> (64 - shift);
+    while (n-- > 0) {
+        big_limb limb = (a[n] << shift) | (n > 0 ? a[n - 1] >> (64 - shift) : 0);
+        q[n] = div_2by1(remainder, remainder, limb, d, v);
+    }
+
+    return remainder >> shift;
 }
 
-#endif  // BIG_INT_ASSIGNMENT_OPERATORS_HPP
+
+/*
+    mod_limb
+    --------
+    Returns a % d over `n` limbs, as `divmod_limb` does, without storing the
+    quotient.
+*/
+
+big_limb mod_limb(const big_limb* a, size_t n, big_limb d) {
+    unsigned shift = std::countl_zero(d);
+    d <<= shift;
+    big_limb v = reciprocal_limb(d);
+
+    big_limb remainder = 0;
+    if (shift != 0 and n > 0)
+        remainder = a[n - 1] >> (64 - shift);
+    while (n-- > 0) {
+        big_limb limb = a[n] << shift;
+        if (shift != 0 and n > 0)
+            limb |= a[n - 1] >> (64 - shift);
+        div_2by1(remainder, remainder, limb, d, v);
+    }
+
+    return remainder >> shift;
+}
+
+
+/*
+    lshift_limbs / rshift_limbs
+    ---------------------------
+    Shift `n` limbs by 1 to 63 bits and return the bits shifted out, placed at
+    the low (left shift) or high (right shift) end of the returned limb.
+*/
+
+big_limb lshift_limbs(big_limb* r, const big_limb* a, size_t n, unsigned bits) {
+    big_limb out = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_limb limb = a[i];
+        r[i] = (limb << bits) | out;
+        out = limb >> (64 - bits);
+    }
+
+    return out;
+}
+
+big_limb rshift_limbs(big_limb* r, const big_limb* a, size_t n, unsigned bits) {
+    big_limb out = 0;
+    while (n-- > 0) {
+        big_limb limb = a[n];
+        r[n] = (limb >> bits) | out;
+        out = limb << (64 - bits);
+    }
+
+    return out;
+}
+
+
+/*
+    sqr_limbs_basecase
+    ------------------
+    Computes the 2n limbs of r = a * a using long multiplication. Each cross
+    product a[i] a[j] with i < j is computed once and doubled with a shift,
+    and the squares a[i]^2 are added along the diagonal, which takes about
+    half the limb products of `mul_limbs_basecase`. `r` must not overlap `a`.
+*/
+
+void sqr_limbs_basecase(big_limb* r, const big_limb* a, size_t n) {
+    r[0] = 0;
+    r[n] = mul_limb(r + 1, a + 1, n - 1, a[0]);
+    for (size_t i = 1; i + 1 < n; i++)
+        r[n + i] = addmul_limb(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    r[2 * n - 1] = 0;
+    lshift_limbs(r, r, 2 * n, 1);
+
+    big_limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_double_limb square = (big_double_limb) a[i] * a[i];
+        big_double_limb sum = (big_double_limb) r[2 * i] + (big_limb) square + carry;
+        r[2 * i] = (big_limb) sum;
+        sum = (big_double_limb) r[2 * i + 1] + (big_limb) (square >> 64) + (big_limb) (sum >> 64);
+        r[2 * i + 1] = (big_limb) sum;
+        carry = (big_limb) (sum >> 64);
+    }
+}
+
+
+/*
+    neg_limbs
+    ---------
+    Computes the two's complement r = -a modulo 2^(64 * n).
+*/
+
+void neg_limbs(big_limb* r, const big_limb* a, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        r[i] = ~a[i];
+    increment_limbs(r, n);
+}
+
+
+/*
+    sub_abs_limbs
+    -------------
+    Computes the `na` limbs of r = |a - b|, where `na` >= `nb` and either
+    operand may have high-order zero limbs. Returns true if a < b.
+*/
+
+bool sub_abs_limbs(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb) {
+    bool a_less = true;
+    for (size_t i = na; i > nb; i--)
+        if (a[i - 1] != 0) {
+            a_less = false;
+            break;
+        }
+    if (a_less) {
+        size_t i = nb;
+        while (i > 0 and a[i - 1] == b[i - 1])
+            i--;
+        a_less = i > 0 and a[i - 1] < b[i - 1];
+    }
+
+    if (a_less) {
+        sub_limbs(r, b, nb, a, nb);
+        for (size_t i = nb; i < na; i++)
+            r[i] = 0;
+    }
+    else
+        sub_limbs(r, a, na, b, nb);
+
+    return a_less;
+}
+
+
+/*
+    divexact_by3_limbs
+    ------------------
+    Computes r = a / 3 modulo 2^(64 * n), which is the exact quotient when
+    `a` is a multiple of 3, also for negative values in two's complement.
+    Each quotient limb is found by multiplying with the inverse of 3 modulo
+    2^64 instead of dividing.
+*/
+
+void divexact_by3_limbs(big_limb* r, const big_limb* a, size_t n) {
+    const big_limb INVERSE_OF_3 = 0xAAAAAAAAAAAAAAABULL;   // 3 * INVERSE_OF_3 = 1 (mod 2^64)
+
+    big_limb borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        big_limb limb = a[i];
+        big_limb diff = limb - borrow;
+        big_limb quotient = diff * INVERSE_OF_3;
+        r[i] = quotient;
+        // 3 * quotient = diff + high * 2^64, so `high` is borrowed from the next limb
+        big_limb high = (big_limb) (((big_double_limb) quotient * 3) >> 64);
+        borrow = high + (limb < borrow);
+    }
+}
+
+#endif  // BIG_INT_LIMB_FUNCTIONS_HPP
 
 
 /*
     ===========================================================================
-    Unary arithmetic operators
+    Multiplication functions
     ===========================================================================
+    The multiplication engine behind BigInt::operator*. `mul_limbs` picks an
+    algorithm from the operand sizes: long multiplication for small operands,
+    a chunked product for unbalanced ones, Karatsuba or Toom-Cook 3-way for
+    large balanced ones, and a number-theoretic transform for huge ones. All
+    the temporary storage below the NTT comes from a single scratch area sized
+    by `mul_limbs_scratch_size`, so the recursion does not allocate.
 */
 
-#ifndef BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
-#define BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
+#ifndef BIG_INT_MULTIPLICATION_FUNCTIONS_HPP
+#define BIG_INT_MULTIPLICATION_FUNCTIONS_HPP
 
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <thread>
 
 
 /*
-    +BigInt
-    -------
-    Returns the value of a BigInt.
-    NOTE: This function does not return the absolute value. To get the absolute
-    value of a BigInt, use the `abs` function.
+    BigIntThresholds
+    ----------------
+    Operand sizes, in limbs, at which the engines switch algorithm, and the
+    number of threads that one large multiplication may use. The sizes come
+    from timing each algorithm against the next one on x86-64; they can be
+    changed at runtime to tune the library for another machine. Parallel
+    multiplication is off by default, as `mul_threads` is 1: each one starts
+    its own threads, so it should only be turned on by programs that do not
+    already run their multiplications on several threads.
 */
 
-BigInt BigInt::operator+() const {
-    return *this;
+struct BigIntThresholds {
+    size_t karatsuba = 24;          // smaller operand size to leave long multiplication (>= 2)
+    size_t toom3 = 160;             // smaller operand size to switch from Karatsuba to Toom-3
+    size_t ntt = 3000;              // smaller operand size to switch to the NTT
+    size_t burnikel_ziegler = 32;   // divisor size to switch to recursive division (>= 4)
+    size_t radix_conversion = 30;   // number size to switch to divide-and-conquer decimal conversion
+    size_t parallel_mul = 1000;     // smaller operand size to spread a multiplication over threads
+    size_t mul_threads = 1;         // threads for one multiplication, 1 to keep it on the calling thread
+};
+
+BigIntThresholds big_int_thresholds;
+
+
+/*
+    run_parallel
+    ------------
+    Runs the `tasks` on up to `threads` threads, the calling thread being one
+    of them, and returns once all of them are done. Task i runs on thread
+    i % threads. An exception thrown by a task is rethrown on the calling
+    thread.
+*/
+
+void run_parallel(const std::vector<std::function<void()>>& tasks, size_t threads) {
+    threads = std::max<size_t>(1, std::min(threads, tasks.size()));
+    std::vector<std::exception_ptr> errors(threads);
+    auto run_share = [&](size_t thread) {
+        try {
+            for (size_t i = thread; i < tasks.size(); i += threads)
+                tasks[i]();
+        }
+        catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads; thread++)
+        workers.emplace_back(run_share, thread);
+    run_share(0);
+    for (std::thread& worker : workers)
+        worker.join();
+
+    for (const std::exception_ptr& error : errors)
+        if (error)
+            std::rethrow_exception(error);
 }
 
 
+void mul_limbs(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch);
+
+
 /*
-    -BigInt
-    -------
-    Returns the negative of a BigInt.
+    karatsuba_threshold
+    -------------------
+    Returns the Karatsuba threshold in effect, which is at least 2: an operand
+    of one limb cannot be split, and the splits would recurse forever.
 */
 
-BigInt BigInt::operator-() const {
-    BigInt temp;
+size_t karatsuba_threshold() {
+    return std::max<size_t>(2, big_int_thresholds.karatsuba);
+}
 
-    temp.value = value;
-    if (value != "0") {
-        if (sign == '+')
-            temp.sign = '-';
+
+/*
+    mul_limbs_scratch_size
+    ----------------------
+    Returns the number of scratch limbs needed by `mul_limbs` for operands of
+    `na` >= `nb` limbs. It follows the same choices as `mul_limbs`.
+*/
+
+size_t mul_limbs_scratch_size(size_t na, size_t nb) {
+    if (nb < karatsuba_threshold() or nb >= big_int_thresholds.ntt)
+        return 0;
+    if (nb <= (na + 1) / 2) {
+        size_t last = na % nb;
+        return 2 * nb + std::max(mul_limbs_scratch_size(nb, nb),
+                                 last ? mul_limbs_scratch_size(nb, last) : 0);
+    }
+
+    size_t k = (na + 2) / 3;
+    if (nb < big_int_thresholds.toom3 or nb <= 2 * k) {
+        size_t h = (na + 1) / 2;
+        return 4 * h + 1 + std::max(mul_limbs_scratch_size(h, h),
+                                mul_limbs_scratch_size(na - h, nb - h));
+    }
+
+    size_t na2 = na - 2 * k, nb2 = nb - 2 * k;
+    return 3 * (2 * k + 2) + 7 * (k + 2) + 2 * (k + 1)
+        + std::max({mul_limbs_scratch_size(k + 1, k + 1),
+                    mul_limbs_scratch_size(k, k),
+                    mul_limbs_scratch_size(std::max(na2, nb2), std::min(na2, nb2))});
+}
+
+
+/*
+    mul_limbs_unbalanced
+    --------------------
+    Computes r = a * b when `a` is at least twice as long as `b`, by slicing
+    `a` into pieces of `nb` limbs and accumulating their products with `b`.
+*/
+
+void mul_limbs_unbalanced(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch) {
+    big_limb* piece_product = scratch;
+    scratch += 2 * nb;
+
+    mul_limbs(r, a, nb, b, nb, scratch);
+    for (size_t i = nb; i < na; i += nb) {
+        size_t piece = std::min(nb, na - i);
+        mul_limbs(piece_product, b, nb, a + i, piece, scratch);
+        // r[i, i + nb) holds the high half of the previous piece's product
+        add_limbs(r + i, piece_product, nb + piece, r + i, nb);
+    }
+}
+
+
+/*
+    mul_limbs_karatsuba
+    -------------------
+    Computes r = a * b using Karatsuba's algorithm. With a = a1 * B + a0 and
+    b = b1 * B + b0, where B = 2^(64 * h):
+        a * b = a1 b1 B^2 + (a1 b1 + a0 b0 - (a0 - a1)(b0 - b1)) B + a0 b0
+    so that three half-size products replace four. When `a` and `b` are the
+    same number, the three products are squares, and `mul_limbs` takes them
+    as such.
+*/
+
+void mul_limbs_karatsuba(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch) {
+    size_t h = (na + 1) / 2;        // size of the low halves
+    size_t na1 = na - h, nb1 = nb - h;
+    size_t nr = na + nb;
+
+    // scratch layout: |a0 - a1|, |b0 - b1| (later the middle term), and
+    // their product
+    big_limb* diff_a = scratch;
+    big_limb* diff_b = scratch + h;
+    big_limb* middle = scratch;
+    big_limb* diff_product = scratch + 2 * h + 1;
+    scratch += 4 * h + 1;
+
+    bool diff_a_negative = sub_abs_limbs(diff_a, a, h, a + h, na1);
+    bool diff_b_negative = diff_a_negative;
+    if (a == b and na == nb)
+        diff_b = diff_a;
+    else
+        diff_b_negative = sub_abs_limbs(diff_b, b, h, b + h, nb1);
+    mul_limbs(diff_product, diff_a, h, diff_b, h, scratch);
+
+    mul_limbs(r, a, h, b, h, scratch);                              // a0 b0
+    mul_limbs(r + 2 * h, a + h, na1, b + h, nb1, scratch);          // a1 b1
+
+    // middle = a0 b0 + a1 b1 - (a0 - a1)(b0 - b1)
+    middle[2 * h] = add_limbs(middle, r, 2 * h, r + 2 * h, nr - 2 * h);
+    if (diff_a_negative == diff_b_negative)
+        sub_limbs(middle, middle, 2 * h + 1, diff_product, 2 * h);
+    else
+        add_limbs(middle, middle, 2 * h + 1, diff_product, 2 * h);
+
+    add_limbs(r + h, r + h, nr - h, middle, std::min(2 * h + 1, nr - h));
+}
+
+
+/*
+    mul_limbs_toom3
+    ---------------
+    Computes r = a * b using Toom-Cook 3-way multiplication. The operands are
+    split into three pieces each, seen as polynomials in B = 2^(64 * k), and
+    their product is found by evaluating them at 0, 1, -1, -2 and infinity,
+    multiplying the five pairs of values and interpolating the product back
+    with Bodrato's sequence. The signed intermediate values are kept in
+    fixed-width two's complement, so plain limb additions and subtractions
+    handle the signs. A square needs only one set of evaluations, and its five
+    products are squares as well. With more than one thread, the five
+    products are computed in parallel.
+*/
+
+void mul_signed_limbs(big_limb* r, const big_limb* x, const big_limb* y,
+        size_t k, big_limb* scratch) {
+    // x and y hold k + 2 limbs in two's complement, and r gets 2k + 2 limbs
+    big_limb* abs_x = scratch;
+    big_limb* abs_y = scratch + k + 1;
+    scratch += 2 * (k + 1);
+
+    bool x_negative = x[k + 1] >> 63;
+    bool y_negative = y[k + 1] >> 63;
+    if (x_negative)
+        neg_limbs(abs_x, x, k + 1);
+    else
+        std::copy(x, x + k + 1, abs_x);
+    if (x == y)     // a square stays a square
+        abs_y = abs_x;
+    else if (y_negative)
+        neg_limbs(abs_y, y, k + 1);
+    else
+        std::copy(y, y + k + 1, abs_y);
+
+    mul_limbs(r, abs_x, k + 1, abs_y, k + 1, scratch);
+    if (x_negative != y_negative)
+        neg_limbs(r, r, 2 * k + 2);
+}
+
+void halve_signed_limbs(big_limb* a, size_t n) {
+    big_limb sign_bit = a[n - 1] & ((big_limb) 1 << 63);
+    rshift_limbs(a, a, n, 1);
+    a[n - 1] |= sign_bit;
+}
+
+void mul_limbs_toom3(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch, size_t threads = 1) {
+    size_t k = (na + 2) / 3;        // size of the two low pieces
+    size_t na2 = na - 2 * k, nb2 = nb - 2 * k;
+    size_t nr = na + nb;
+    size_t w = 2 * k + 2;           // width of the products
+    size_t e = k + 2;               // width of the evaluated values
+
+    big_limb* r1 = scratch;
+    big_limb* rm1 = r1 + w;
+    big_limb* rm2 = rm1 + w;
+    big_limb* p1 = rm2 + w;
+    big_limb* pm1 = p1 + e;
+    big_limb* pm2 = pm1 + e;
+    big_limb* q1 = pm2 + e;
+    big_limb* qm1 = q1 + e;
+    big_limb* qm2 = qm1 + e;
+    big_limb* temp = qm2 + e;
+    scratch = temp + e;
+
+    // evaluate p(x) = a2 x^2 + a1 x + a0 at 1, -1 and -2:
+    //     p(1) = (a0 + a2) + a1,  p(-1) = (a0 + a2) - a1,
+    //     p(-2) = 2 (p(-1) + a2) - a0
+    auto evaluate = [&](const big_limb* x, size_t n2,
+            big_limb* v1, big_limb* vm1, big_limb* vm2) {
+        temp[k] = add_limbs(temp, x, k, x + 2 * k, n2);
+        temp[k + 1] = 0;
+        add_limbs(v1, temp, e, x + k, k);
+        sub_limbs(vm1, temp, e, x + k, k);
+        add_limbs(vm2, vm1, e, x + 2 * k, n2);
+        lshift_limbs(vm2, vm2, e, 1);
+        sub_limbs(vm2, vm2, e, x, k);
+    };
+    evaluate(a, na2, p1, pm1, pm2);
+    if (a == b and na == nb) {
+        q1 = p1;
+        qm1 = pm1;
+        qm2 = pm2;
+    }
+    else
+        evaluate(b, nb2, q1, qm1, qm2);
+
+    // pointwise products; r(0) and r(inf) go straight to their final place
+    const big_limb* r0 = r;
+    big_limb* rinf = r + 4 * k;
+    size_t ninf = na2 + nb2;
+    auto mul_inf = [&](big_limb* scratch) {
+        if (na2 >= nb2)
+            mul_limbs(rinf, a + 2 * k, na2, b + 2 * k, nb2, scratch);
         else
-            temp.sign = '+';
+            mul_limbs(rinf, b + 2 * k, nb2, a + 2 * k, na2, scratch);
+    };
+    if (threads > 1) {
+        // the five products are independent, so each gets its own scratch
+        size_t task_scratch_size = 2 * (k + 1) + mul_limbs_scratch_size(k + 1, k + 1);
+        std::vector<std::vector<big_limb>> scratches(5, std::vector<big_limb>(task_scratch_size));
+        run_parallel({
+            [&] { mul_limbs(r1, p1, k + 1, q1, k + 1, scratches[0].data()); },
+            [&] { mul_signed_limbs(rm1, pm1, qm1, k, scratches[1].data()); },
+            [&] { mul_signed_limbs(rm2, pm2, qm2, k, scratches[2].data()); },
+            [&] { mul_limbs(r, a, k, b, k, scratches[3].data()); },
+            [&] { mul_inf(scratches[4].data()); },
+        }, threads);
+    }
+    else {
+        mul_limbs(r1, p1, k + 1, q1, k + 1, scratch);
+        mul_signed_limbs(rm1, pm1, qm1, k, scratch);
+        mul_signed_limbs(rm2, pm2, qm2, k, scratch);
+        mul_limbs(r, a, k, b, k, scratch);
+        mul_inf(scratch);
     }
 
-    return temp;
+    // interpolate the coefficients r1, r2 and r3 (kept in r1, rm1 and rm2)
+    sub_limbs(rm2, rm2, w, r1, w);
+    divexact_by3_limbs(rm2, rm2, w);            // r3 = (r(-2) - r(1)) / 3
+    sub_limbs(r1, r1, w, rm1, w);
+    halve_signed_limbs(r1, w);                  // r1 = (r(1) - r(-1)) / 2
+    sub_limbs(rm1, rm1, w, r0, 2 * k);          // r2 = r(-1) - r(0)
+    sub_limbs(rm2, rm1, w, rm2, w);
+    halve_signed_limbs(rm2, w);
+    add_limbs(rm2, rm2, w, rinf, ninf);
+    add_limbs(rm2, rm2, w, rinf, ninf);         // r3 = (r2 - r3) / 2 + 2 r(inf)
+    add_limbs(rm1, rm1, w, r1, w);
+    sub_limbs(rm1, rm1, w, rinf, ninf);         // r2 = r2 + r1 - r(inf)
+    sub_limbs(r1, r1, w, rm2, w);               // r1 = r1 - r3
+
+    // recompose r = r(inf) B^4 + r3 B^3 + r2 B^2 + r1 B + r(0)
+    std::fill(r + 2 * k, r + 4 * k, 0);
+    add_limbs(r + k, r + k, nr - k, r1, w);
+    add_limbs(r + 2 * k, r + 2 * k, nr - 2 * k, rm1, w);
+    add_limbs(r + 3 * k, r + 3 * k, nr - 3 * k, rm2, std::min(w, nr - 3 * k));
+}
+
+
+/*
+    NttPrime
+    --------
+    One of the primes p = c * 2^50 + 1 < 2^62 used by the number-theoretic
+    transform, with the constants for Montgomery arithmetic modulo p, where
+    R = 2^64. Values in Montgomery form are stored as x * R mod p, so that
+    `mul` (which returns a * b / R mod p) never divides.
+*/
+
+struct NttPrime {
+    big_limb p;
+    big_limb generator;         // primitive root modulo p
+    big_limb p_inverse;         // p^-1 mod 2^64
+    big_limb r_squared;         // R^2 mod p
+
+    constexpr NttPrime(big_limb prime, big_limb primitive_root) {
+        p = prime;
+        generator = primitive_root;
+        // Newton's iteration doubles the number of correct low bits each step
+        p_inverse = p;
+        for (int i = 0; i < 5; i++)
+            p_inverse *= 2 - p * p_inverse;
+        big_limb r_mod_p = (big_limb) (((big_double_limb) 1 << 64) % p);
+        r_squared = (big_limb) ((big_double_limb) r_mod_p * r_mod_p % p);
+    }
+
+    // Returns t / R mod p, for t < p * R
+    constexpr big_limb reduce(big_double_limb t) const {
+        big_limb m = (big_limb) t * p_inverse;
+        big_limb high = (big_limb) (t >> 64);
+        big_limb mp_high = (big_limb) (((big_double_limb) m * p) >> 64);
+        return high >= mp_high ? high - mp_high : high - mp_high + p;
+    }
+
+    constexpr big_limb mul(big_limb a, big_limb b) const {
+        return reduce((big_double_limb) a * b);
+    }
+
+    // Returns a * b / R mod p in (0, 2p), for a < 4p and b < p
+    constexpr big_limb mul_lazy(big_limb a, big_limb b) const {
+        big_double_limb t = (big_double_limb) a * b;
+        big_limb m = (big_limb) t * p_inverse;
+        return (big_limb) (t >> 64) - (big_limb) (((big_double_limb) m * p) >> 64) + p;
+    }
+
+    constexpr big_limb add(big_limb a, big_limb b) const {
+        big_limb sum = a + b;
+        return sum >= p ? sum - p : sum;
+    }
+
+    constexpr big_limb sub(big_limb a, big_limb b) const {
+        return a >= b ? a - b : a - b + p;
+    }
+
+    // Returns x * R mod p for any 64-bit x
+    constexpr big_limb to_montgomery(big_limb x) const {
+        return mul(x, r_squared);
+    }
+
+    constexpr big_limb power(big_limb base, big_limb exp) const {
+        big_limb result = to_montgomery(1);
+        for (; exp; exp >>= 1) {
+            if (exp & 1)
+                result = mul(result, base);
+            base = mul(base, base);
+        }
+
+        return result;
+    }
+};
+
+inline constexpr NttPrime NTT_PRIMES[3] = {
+    NttPrime(4601552919265804289ULL, 3),    // 4087 * 2^50 + 1
+    NttPrime(4522739925786820609ULL, 37),   // 4017 * 2^50 + 1
+    NttPrime(4500221927649968129ULL, 3),    // 3997 * 2^50 + 1
+};
+
+
+/*
+    ntt_roots
+    ---------
+    Fills `roots` so that roots[half + j] = w^j for 0 <= j < half, where w is
+    the primitive (2 * half)-th root of unity (or its inverse), for every
+    power of two `half` below `n`. Values are in Montgomery form.
+*/
+
+void ntt_roots(const NttPrime& prime, size_t n, bool inverse, std::vector<big_limb>& roots) {
+    roots.resize(n);
+    big_limb generator = prime.to_montgomery(prime.generator);
+    for (size_t half = 1; half < n; half *= 2) {
+        big_limb w = prime.power(generator, (prime.p - 1) / (2 * half));
+        if (inverse)
+            w = prime.power(w, 2 * half - 1);
+        roots[half] = prime.to_montgomery(1);
+        for (size_t j = 1; j < half; j++)
+            roots[half + j] = prime.mul(roots[half + j - 1], w);
+    }
+}
+
+
+/*
+    ntt_forward / ntt_inverse
+    -------------------------
+    In-place transforms of length `n` (a power of two). The forward transform
+    uses decimation in frequency and leaves its output in bit-reversed order,
+    which is exactly the input order the decimation-in-time inverse expects,
+    so no bit-reversal permutation is needed. The inverse is not scaled by
+    1/n. Both keep their values in [0, 2p) and only fully reduce them at the
+    end (Harvey's lazy butterflies), which saves most of the corrections.
+*/
+
+void ntt_forward(const NttPrime& prime, big_limb* a, size_t n, const big_limb* roots) {
+    big_limb two_p = 2 * prime.p;
+    for (size_t half = n / 2; half >= 1; half /= 2)
+        for (size_t start = 0; start < n; start += 2 * half)
+            for (size_t j = 0; j < half; j++) {
+                big_limb u = a[start + j], v = a[start + j + half];
+                big_limb sum = u + v;
+                a[start + j] = sum >= two_p ? sum - two_p : sum;
+                a[start + j + half] = prime.mul_lazy(u - v + two_p, roots[half + j]);
+            }
+}
+
+void ntt_inverse(const NttPrime& prime, big_limb* a, size_t n, const big_limb* roots) {
+    big_limb two_p = 2 * prime.p;
+    for (size_t half = 1; half < n; half *= 2)
+        for (size_t start = 0; start < n; start += 2 * half)
+            for (size_t j = 0; j < half; j++) {
+                big_limb u = a[start + j];
+                big_limb v = prime.mul_lazy(a[start + j + half], roots[half + j]);
+                big_limb sum = u + v, diff = u - v + two_p;
+                a[start + j] = sum >= two_p ? sum - two_p : sum;
+                a[start + j + half] = diff >= two_p ? diff - two_p : diff;
+            }
+}
+
+
+/*
+    ntt_convolution
+    ---------------
+    Computes the cyclic convolution of `a` and `b`, zero-padded to length
+    `n`, modulo one of the NTT primes. The result holds plain residues. A
+    square is transformed once and squared pointwise.
+*/
+
+std::vector<big_limb> ntt_convolution(const NttPrime& prime, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, size_t n) {
+    bool square = a == b and na == nb;
+    std::vector<big_limb> fa(n, 0), fb(square ? 0 : n, 0), roots;
+
+    // to_montgomery() also reduces the limbs modulo p
+    for (size_t i = 0; i < na; i++)
+        fa[i] = prime.to_montgomery(a[i]);
+    if (not square)
+        for (size_t i = 0; i < nb; i++)
+            fb[i] = prime.to_montgomery(b[i]);
+
+    ntt_roots(prime, n, false, roots);
+    ntt_forward(prime, fa.data(), n, roots.data());
+    if (not square)
+        ntt_forward(prime, fb.data(), n, roots.data());
+    const big_limb* fx = square ? fa.data() : fb.data();
+    for (size_t i = 0; i < n; i++)
+        fa[i] = prime.mul_lazy(fa[i], fx[i] >= prime.p ? fx[i] - prime.p : fx[i]);
+
+    ntt_roots(prime, n, true, roots);
+    ntt_inverse(prime, fa.data(), n, roots.data());
+
+    // multiplying by 1/n (not in Montgomery form) also leaves Montgomery form
+    big_limb n_inverse = prime.mul(prime.power(prime.to_montgomery(n), prime.p - 2), 1);
+    for (size_t i = 0; i < n; i++)
+        fa[i] = prime.mul(fa[i] >= prime.p ? fa[i] - prime.p : fa[i], n_inverse);
+
+    return fa;
+}
+
+
+/*
+    mul_limbs_ntt
+    -------------
+    Computes the `na` + `nb` limbs of r = a * b in quasi-linear time. The
+    limbs are treated as the coefficients of two polynomials, which are
+    multiplied modulo three primes with number-theoretic transforms. The
+    exact coefficients, below n * 2^128 < p1 p2 p3, are rebuilt with the
+    Chinese remainder theorem (Garner's algorithm) and their carries
+    propagated into `r`. With more than one thread, the three convolutions
+    run in parallel.
+*/
+
+void mul_limbs_ntt(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, size_t threads = 1) {
+    size_t nr = na + nb;
+    size_t n = 1;
+    while (n < nr)
+        n *= 2;
+
+    std::vector<big_limb> residues[3];
+    auto convolution = [&](int k) {
+        residues[k] = ntt_convolution(NTT_PRIMES[k], a, na, b, nb, n);
+    };
+    if (threads > 1)
+        run_parallel({[&] { convolution(0); }, [&] { convolution(1); },
+                      [&] { convolution(2); }}, threads);
+    else
+        for (int k = 0; k < 3; k++)
+            convolution(k);
+
+    constexpr const NttPrime& prime1 = NTT_PRIMES[0];
+    constexpr const NttPrime& prime2 = NTT_PRIMES[1];
+    constexpr const NttPrime& prime3 = NTT_PRIMES[2];
+    constexpr big_limb p1 = prime1.p, p2 = prime2.p, p3 = prime3.p;
+    constexpr big_double_limb p1p2 = (big_double_limb) p1 * p2;
+
+    // Garner's constants, with the primes sorted so that p1 < 2 p2 and p1, p2 < 2 p3,
+    // worked out at compile time
+    constexpr auto mod_inverse = [](const NttPrime& prime, big_limb x) {
+        return prime.power(prime.to_montgomery(x), prime.p - 2);
+    };
+    constexpr big_limb p1_inverse_mod_p2 = mod_inverse(prime2, p1 - p2);
+    constexpr big_limb p1_mod_p3 = prime3.to_montgomery(p1);
+    constexpr big_limb p1p2_inverse_mod_p3 = mod_inverse(prime3, (big_limb) (p1p2 % p3));
+
+    big_limb carry0 = 0, carry1 = 0, carry2 = 0;
+    for (size_t i = 0; i < nr; i++) {
+        big_limb r1 = residues[0][i], r2 = residues[1][i], r3 = residues[2][i];
+
+        // x = r1 + p1 t2 + p1 p2 t3, with t2 < p2 and t3 < p3
+        big_limb t2 = prime2.mul(prime2.sub(r2, r1 >= p2 ? r1 - p2 : r1), p1_inverse_mod_p2);
+        big_limb x12_mod_p3 = prime3.add(r1 >= p3 ? r1 - p3 : r1,
+                                         prime3.mul(t2 >= p3 ? t2 - p3 : t2, p1_mod_p3));
+        big_limb t3 = prime3.mul(prime3.sub(r3, x12_mod_p3), p1p2_inverse_mod_p3);
+
+        big_double_limb x12 = (big_double_limb) p1 * t2 + r1;
+        big_double_limb low = (big_double_limb) (big_limb) p1p2 * t3;
+        big_double_limb high = (big_double_limb) (big_limb) (p1p2 >> 64) * t3;
+
+        // add x to the running carry and emit its lowest limb
+        big_double_limb sum = (big_double_limb) carry0 + (big_limb) x12 + (big_limb) low;
+        r[i] = (big_limb) sum;
+        sum = (sum >> 64) + carry1 + (big_limb) (x12 >> 64) + (big_limb) (low >> 64)
+            + (big_limb) high;
+        carry0 = (big_limb) sum;
+        sum = (sum >> 64) + carry2 + (big_limb) (high >> 64);
+        carry1 = (big_limb) sum;
+        carry2 = (big_limb) (sum >> 64);
+    }
+}
+
+
+/*
+    mul_limbs
+    ---------
+    Computes the `na` + `nb` limbs of r = a * b, where `na` >= `nb` >= 1.
+    `r` must not overlap either operand, and `scratch` must hold at least
+    `mul_limbs_scratch_size(na, nb)` limbs. When `a` and `b` are the same
+    limbs, every algorithm computes a square, which saves part of the work.
+*/
+
+void mul_limbs(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch) {
+    if (nb >= big_int_thresholds.ntt)
+        mul_limbs_ntt(r, a, na, b, nb);
+    else if (nb < karatsuba_threshold() and a == b and na == nb)
+        sqr_limbs_basecase(r, a, na);
+    else if (nb < karatsuba_threshold())
+        mul_limbs_basecase(r, a, na, b, nb);
+    else if (nb <= (na + 1) / 2)
+        mul_limbs_unbalanced(r, a, na, b, nb, scratch);
+    else if (nb < big_int_thresholds.toom3 or nb <= 2 * ((na + 2) / 3))
+        mul_limbs_karatsuba(r, a, na, b, nb, scratch);
+    else
+        mul_limbs_toom3(r, a, na, b, nb, scratch);
+}
+
+
+/*
+    mul_scratch
+    -----------
+    Returns a per-thread scratch area of at least `size` limbs. The area is
+    kept between calls, so repeated multiplications reuse it.
+*/
+
+big_limb* mul_scratch(size_t size) {
+    thread_local std::vector<big_limb> scratch;
+    if (scratch.size() < size)
+        scratch.resize(size);
+
+    return scratch.data();
+}
+
+
+/*
+    mul_limbs_parallel
+    ------------------
+    Computes r = a * b as `mul_limbs` does, spreading the top level of the
+    work over `big_int_thresholds.mul_threads` threads when the smaller
+    operand reaches `big_int_thresholds.parallel_mul` limbs: the three NTT
+    convolutions, or the five Toom-3 products, run at the same time. Lower
+    levels, and unbalanced operands, stay on one thread each.
+*/
+
+void mul_limbs_parallel(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, big_limb* scratch) {
+    size_t threads = big_int_thresholds.mul_threads;
+    if (threads <= 1 or nb < big_int_thresholds.parallel_mul)
+        mul_limbs(r, a, na, b, nb, scratch);
+    else if (nb >= big_int_thresholds.ntt)
+        mul_limbs_ntt(r, a, na, b, nb, threads);
+    else if (nb > (na + 1) / 2 and nb >= big_int_thresholds.toom3 and nb > 2 * ((na + 2) / 3))
+        mul_limbs_toom3(r, a, na, b, nb, scratch, threads);
+    else
+        mul_limbs(r, a, na, b, nb, scratch);
+}
+
+#endif  // BIG_INT_MULTIPLICATION_FUNCTIONS_HPP
+
+
+/*
+    ===========================================================================
+    Division functions
+    ===========================================================================
+    The division kernels behind BigInt's `/`, `%` and `divmod`: Knuth's long
+    division, and Burnikel and Ziegler's recursive division on top of it for
+    large operands.
+*/
+
+#ifndef BIG_INT_DIVISION_FUNCTIONS_HPP
+#define BIG_INT_DIVISION_FUNCTIONS_HPP
+
+
+
+/*
+    divrem_limbs_knuth
+    ------------------
+    Knuth's Algorithm D on a normalized divisor `d` (`nd` >= 2 limbs, top bit
+    set). `u` holds `nd` + `nq` limbs, and its top `nd` limbs must be less
+    than `d`. The `nq` quotient limbs are stored in `q`, and `u` is left with
+    the remainder in its low `nd` limbs.
+    Each quotient limb is estimated from the top two limbs of the divisor,
+    which is off by at most one after the correction step, so at most one
+    add-back is needed.
+*/
+
+void divrem_limbs_knuth(big_limb* q, big_limb* u, size_t nq, const big_limb* d, size_t nd) {
+    big_limb d1 = d[nd - 1], d0 = d[nd - 2];
+    big_limb v = reciprocal_limb(d1);
+
+    for (size_t j = nq; j-- > 0; ) {
+        big_limb* window = u + j;       // the nd + 1 limbs being divided
+        big_limb u2 = window[nd], u1 = window[nd - 1], u0 = window[nd - 2];
+
+        // estimate the quotient limb from the top limbs
+        big_limb q_hat, r_hat;
+        bool r_hat_overflow = false;
+        if (u2 == d1) {
+            q_hat = ~(big_limb) 0;
+            r_hat = u1 + d1;
+            r_hat_overflow = r_hat < d1;
+        }
+        else
+            q_hat = div_2by1(r_hat, u2, u1, d1, v);
+        while (!r_hat_overflow and
+               (big_double_limb) q_hat * d0 > (((big_double_limb) r_hat << 64) | u0)) {
+            q_hat--;
+            r_hat += d1;
+            r_hat_overflow = r_hat < d1;
+        }
+
+        // subtract q_hat * d, adding d back if that went negative
+        big_limb borrow = submul_limb(window, d, nd, q_hat);
+        if (window[nd] < borrow) {
+            q_hat--;
+            add_limbs(window, window, nd, d, nd);
+        }
+        window[nd] = 0;
+        q[j] = q_hat;
+    }
 }
 
-#endif  // BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
+
+/*
+    divrem_limbs_schoolbook
+    -----------------------
+    Divides the `nu` limbs of `u` by the normalized `d` (`nd` >= 2 limbs,
+    `nu` >= `nd`) with Algorithm D, without restrictions on the top limbs of
+    `u`. The low `nu` - `nd` quotient limbs go to `q` and the top one, 0 or 1,
+    is returned. `u` is left with the remainder in its low `nd` limbs.
+*/
+
+big_limb divrem_limbs_schoolbook(big_limb* q, big_limb* u, size_t nu,
+        const big_limb* d, size_t nd) {
+    big_limb* top = u + nu - nd;
+    big_limb q_high = compare_limbs(top, nd, d, nd) >= 0;
+    if (q_high)
+        sub_limbs(top, top, nd, d, nd);
+    divrem_limbs_knuth(q, u, nu - nd, d, nd);
+
+    return q_high;
+}
+
+
+/*
+    divrem_limbs_recursive / divrem_limbs_block
+    -------------------------------------------
+    Burnikel and Ziegler's recursive division, in the form used by GMP.
+    `divrem_limbs_recursive` divides the 2n limbs of `u` by the normalized `n`
+    limbs of `d`: it finds the high and then the low half of the quotient
+    with `divrem_limbs_block`, which gets `k` <= `n` quotient limbs of
+    u[0, n + k) by dividing the top 2k limbs of `u` by the top `k` limbs of
+    `d` (recursively), and then correcting the estimate with one
+    multiplication by the rest of `d`. Division thus costs a small multiple of
+    a multiplication of the same size.
+    Both store the low quotient limbs in `q`, return the top quotient limb (0
+    or 1) and leave the remainder in the low `n` limbs of `u`. `temp` holds
+    `n` limbs.
+*/
+
+big_limb divrem_limbs_block(big_limb* q, big_limb* u, size_t k,
+        const big_limb* d, size_t n, big_limb* temp);
+
+big_limb divrem_limbs_recursive(big_limb* q, big_limb* u, const big_limb* d,
+        size_t n, big_limb* temp) {
+    if (n < big_int_thresholds.burnikel_ziegler)
+        return divrem_limbs_schoolbook(q, u, 2 * n, d, n);
+
+    size_t low = n / 2, high = n - low;
+    big_limb q_high = divrem_limbs_block(q + low, u + low, high, d, n, temp);
+    divrem_limbs_block(q, u, low, d, n, temp);
+
+    return q_high;
+}
+
+big_limb divrem_limbs_block(big_limb* q, big_limb* u, size_t k,
+        const big_limb* d, size_t n, big_limb* temp) {
+    if (k == n)
+        return divrem_limbs_recursive(q, u, d, n, temp);
+    if (k < big_int_thresholds.burnikel_ziegler)
+        return divrem_limbs_schoolbook(q, u, n + k, d, n);
+
+    // estimate the quotient from the top limbs; the remainder of this
+    // division is in u[n - k, n), so u[0, n) now holds the partial remainder
+    size_t low = n - k;
+    big_limb q_high = divrem_limbs_recursive(q, u + low, d + low, k, temp);
+
+    // subtract the estimate times the low limbs of the divisor
+    if (low >= k)
+        mul_limbs(temp, d, low, q, k, mul_scratch(mul_limbs_scratch_size(low, k)));
+    else
+        mul_limbs(temp, q, k, d, low, mul_scratch(mul_limbs_scratch_size(k, low)));
+    big_limb borrow = sub_limbs(u, u, n, temp, n);
+    if (q_high)
+        borrow += sub_limbs(u + k, u + k, low, d, low);
+
+    // the estimate can only be too large; add the divisor back until the
+    // partial remainder is non-negative
+    while (borrow) {
+        q_high -= decrement_limbs(q, k);
+        borrow -= add_limbs(u, u, n, d, n);
+    }
+
+    return q_high;
+}
+
+
+/*
+    divrem_limbs_burnikel_ziegler
+    -----------------------------
+    Divides `u` (`nd` + `nq` limbs, with its top `nd` limbs less than the
+    normalized `d`) block by block: each block of `nd` quotient limbs, and a
+    shorter one at the top, comes from one recursive division.
+*/
+
+void divrem_limbs_burnikel_ziegler(big_limb* q, big_limb* u, size_t nq,
+        const big_limb* d, size_t nd) {
+    std::vector<big_limb> temp(nd);
+    size_t j = nq;
+    size_t k = nq % nd ? nq % nd : nd;      // the top block takes the leftover limbs
+    while (j > 0) {
+        j -= k;
+        divrem_limbs_block(q + j, u + j, k, d, nd, temp.data());
+        k = nd;
+    }
+}
+
+
+/*
+    divrem_limbs
+    ------------
+    Computes the `na` - `nb` + 1 limbs of q = a / b and the `nb` limbs of
+    r = a % b, where `na` >= `nb` >= 1 and the top limb of `b` is non-zero.
+    Neither `q` nor `r` may overlap the operands.
+*/
+
+void divrem_limbs(big_limb* q, big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb) {
+    if (nb == 1) {
+        r[0] = divmod_limb(q, a, na, b[0]);
+        return;
+    }
+
+    // normalize: shift both operands so that the divisor's top bit is set
+    unsigned shift = std::countl_zero(b[nb - 1]);
+    std::vector<big_limb> d(b, b + nb), u(na + 1);
+    if (shift) {
+        lshift_limbs(d.data(), b, nb, shift);
+        u[na] = lshift_limbs(u.data(), a, na, shift);
+    }
+    else {
+        std::copy(a, a + na, u.begin());
+        u[na] = 0;
+    }
+
+    size_t nq = na - nb + 1;
+    if (nb >= big_int_thresholds.burnikel_ziegler and nq >= big_int_thresholds.burnikel_ziegler)
+        divrem_limbs_burnikel_ziegler(q, u.data(), nq, d.data(), nb);
+    else
+        divrem_limbs_knuth(q, u.data(), nq, d.data(), nb);
+
+    if (shift)
+        rshift_limbs(r, u.data(), nb, shift);
+    else
+        std::copy(u.begin(), u.begin() + nb, r);
+}
+
+#endif  // BIG_INT_DIVISION_FUNCTIONS_HPP
+
+
+/*
+    ===========================================================================
+    Radix conversion functions
+    ===========================================================================
+    Conversion of limb magnitudes to and from decimal digits. Short numbers are
+    converted one 19-digit chunk at a time; longer ones are split in two around
+    a power of ten, so that the work is done by a few large multiplications or
+    divisions instead of a quadratic number of limb operations.
+*/
+
+#ifndef BIG_INT_RADIX_CONVERSION_FUNCTIONS_HPP
+#define BIG_INT_RADIX_CONVERSION_FUNCTIONS_HPP
+
+#include <deque>
+
+
+inline constexpr size_t DIGITS_PER_LIMB = 19;
+inline constexpr big_limb LIMB_POW10 = 10000000000000000000ULL;    // 10^DIGITS_PER_LIMB
+
+
+/*
+    Pow10Limbs
+    ----------
+    A power of ten 10^e stored as `limbs` * 2^(64 * `zero_limbs`). Since
+    10^e = 5^e * 2^e, dropping the low zero limbs makes the stored part about
+    a third shorter, and splitting a number around 10^e only has to divide or
+    multiply by that part. `inverse` is a scaled reciprocal of `limbs`, used to
+    replace repeated divisions by the same power with multiplications; it is
+    only computed once a second division asks for it.
+*/
+
+struct Pow10Limbs {
+    std::vector<big_limb> limbs;
+    size_t zero_limbs;
+    size_t digits;                      // the exponent e
+    std::vector<big_limb> inverse;      // empty until needed
+    size_t divisions;                   // divisions done without `inverse`
+};
+
+
+/*
+    pow10_limbs
+    -----------
+    Returns 10^(19 * 2^k). The powers are computed by repeated squaring the
+    first time they are needed and then kept in a per-thread table, so later
+    conversions of similar sizes reuse them.
+*/
+
+Pow10Limbs& pow10_limbs(size_t k) {
+    // a deque keeps references to earlier entries valid while it grows
+    thread_local std::deque<Pow10Limbs> table;
+    if (table.empty())
+        table.push_back({{LIMB_POW10}, 0, DIGITS_PER_LIMB, {}, 0});
+
+    while (table.size() <= k) {
+        const Pow10Limbs& last = table.back();
+        size_t n = last.limbs.size();
+        Pow10Limbs next{std::vector<big_limb>(2 * n), 2 * last.zero_limbs, 2 * last.digits, {}, 0};
+        mul_limbs(next.limbs.data(), last.limbs.data(), n, last.limbs.data(), n,
+                  mul_scratch(mul_limbs_scratch_size(n, n)));
+        strip_leading_zeroes(next.limbs);
+
+        size_t zeroes = 0;
+        while (next.limbs[zeroes] == 0)
+            zeroes++;
+        next.limbs.erase(next.limbs.begin(), next.limbs.begin() + zeroes);
+        next.zero_limbs += zeroes;
+        table.push_back(std::move(next));
+    }
+
+    return table[k];
+}
+
+
+/*
+    pow10_level
+    -----------
+    Returns the largest k such that 19 * 2^k < `digits`, where `digits` > 19:
+    the power 10^(19 * 2^k) splits a `digits`-long number into two parts with
+    the lower one at least as long as the upper one.
+*/
+
+size_t pow10_level(size_t digits) {
+    size_t k = 0;
+    while ((DIGITS_PER_LIMB << (k + 1)) < digits)
+        k++;
+
+    return k;
+}
+
+
+/*
+    divrem_pow10
+    ------------
+    Computes q = a / p and r = a % p for the stored part p of `power`, where
+    `a` has `na` limbs and a < p^2 * 2^(64 * z), as is the case when splitting
+    a number of at most twice the power's digits. `q` has `np` + `z` + 1 limbs
+    and `r` has `np` limbs. Large powers use Barrett's method: with the reciprocal
+    v = floor(2^(64 * (2 * np + z)) / p), the quotient estimated from the top
+    limbs of a * v is at most 2 too small, so the work is two multiplications
+    once the reciprocal is known. The first division by a power is done
+    directly, as the reciprocal costs about as much as one division.
+*/
+
+void divrem_pow10(big_limb* q, big_limb* r, const big_limb* a, size_t na, Pow10Limbs& power) {
+    const big_limb* p = power.limbs.data();
+    size_t np = power.limbs.size();
+    size_t nq = np + power.zero_limbs;
+    std::fill(q, q + nq + 1, 0);
+    if (np < big_int_thresholds.burnikel_ziegler or power.divisions == 0) {
+        divrem_limbs(q, r, a, na, p, np);
+        power.divisions++;
+        return;
+    }
+
+    if (power.inverse.empty()) {
+        std::vector<big_limb> numerator(np + nq + 1, 0);
+        numerator[np + nq] = 1;
+        std::vector<big_limb> remainder(np);
+        power.inverse.resize(nq + 2);
+        divrem_limbs(power.inverse.data(), remainder.data(), numerator.data(), numerator.size(), p, np);
+        strip_leading_zeroes(power.inverse);
+    }
+
+    // estimate the quotient from floor(a / 2^(64 * (np - 1))) * v
+    const big_limb* a_top = a + (np - 1);
+    size_t n_top = na - (np - 1);
+    const std::vector<big_limb>& v = power.inverse;
+    std::vector<big_limb> estimate(n_top + v.size());
+    if (n_top >= v.size())
+        mul_limbs(estimate.data(), a_top, n_top, v.data(), v.size(),
+                  mul_scratch(mul_limbs_scratch_size(n_top, v.size())));
+    else
+        mul_limbs(estimate.data(), v.data(), v.size(), a_top, n_top,
+                  mul_scratch(mul_limbs_scratch_size(v.size(), n_top)));
+    size_t n_est = std::min(estimate.size() - (nq + 1), nq + 1);
+    std::copy(estimate.begin() + (nq + 1), estimate.begin() + (nq + 1) + n_est, q);
+
+    // r = a - q * p, then correct the estimate
+    size_t nq_used = nq + 1;
+    while (nq_used > 0 and q[nq_used - 1] == 0)
+        nq_used--;
+    std::vector<big_limb> remainder(na, 0);
+    std::copy(a, a + na, remainder.begin());
+    if (nq_used > 0) {
+        std::vector<big_limb> product(nq_used + np);
+        if (nq_used >= np)
+            mul_limbs(product.data(), q, nq_used, p, np,
+                      mul_scratch(mul_limbs_scratch_size(nq_used, np)));
+        else
+            mul_limbs(product.data(), p, np, q, nq_used,
+                      mul_scratch(mul_limbs_scratch_size(np, nq_used)));
+        size_t n_product = product.size();
+        while (n_product > 0 and product[n_product - 1] == 0)
+            n_product--;
+        sub_limbs(remainder.data(), remainder.data(), na, product.data(), n_product);
+    }
+    strip_leading_zeroes(remainder);
+    while (compare_limbs(remainder.data(), remainder.size(), p, np) >= 0) {
+        sub_limbs(remainder.data(), remainder.data(), remainder.size(), p, np);
+        strip_leading_zeroes(remainder);
+        increment_limbs(q, nq + 1);
+    }
+    std::copy(remainder.begin(), remainder.end(), r);
+    std::fill(r + remainder.size(), r + np, 0);
+}
+
+
+/*
+    write_zero_digits
+    -----------------
+    Passes `count` '0' digits to `write`, one block at a time.
+*/
+
+template <typename Write>
+void write_zero_digits(Write& write, size_t count) {
+    static const char zeroes[] = "0000000000000000000000000000000000000000000000000000000000000000";
+    for (size_t block = sizeof(zeroes) - 1; count > 0; count -= std::min(count, block))
+        write(zeroes, std::min(count, block));
+}
+
+
+/*
+    limbs_to_decimal
+    ----------------
+    Writes the `n` limbs of `a` as exactly `width` decimal digits, padded with
+    leading zeroes, where a < 10^width. The digits go from the most to the
+    least significant one to `write(const char* digits, size_t count)`, in
+    blocks of at most 64 digits, so they never have to be gathered in one
+    string. Above the radix conversion threshold, `a` is divided by a power of
+    ten close to half its length and both halves are converted recursively.
+*/
+
+template <typename Write>
+void limbs_to_decimal(Write& write, size_t width, const big_limb* a, size_t n) {
+    while (n > 0 and a[n - 1] == 0)
+        n--;
+
+    if (n < big_int_thresholds.radix_conversion or width <= DIGITS_PER_LIMB) {
+        // the 19-digit chunks come out from the lowest one, so they are kept
+        // until the top one is known
+        std::vector<big_limb> quotient(a, a + n), chunks;
+        while (!quotient.empty()) {
+            chunks.push_back(divmod_limb(quotient.data(), quotient.data(),
+                                         quotient.size(), LIMB_POW10));
+            strip_leading_zeroes(quotient);
+        }
+
+        size_t chunk_digits = DIGITS_PER_LIMB * chunks.size();
+        if (width > chunk_digits)
+            write_zero_digits(write, width - chunk_digits);
+        for (size_t i = chunks.size(); i-- > 0;) {
+            char digits[DIGITS_PER_LIMB];
+            big_limb chunk = chunks[i];
+            for (size_t j = DIGITS_PER_LIMB; j-- > 0;) {
+                digits[j] = '0' + chunk % 10;
+                chunk /= 10;
+            }
+            // only the top chunk can hold fewer digits than a full one
+            size_t count = std::min(DIGITS_PER_LIMB, width - DIGITS_PER_LIMB * i);
+            write(digits + DIGITS_PER_LIMB - count, count);
+        }
+        return;
+    }
+
+    Pow10Limbs& power = pow10_limbs(pow10_level(width));
+    size_t low_width = power.digits;
+    size_t np = power.limbs.size();
+    size_t z = power.zero_limbs;
+    if (n < z + np) {     // a < 10^low_width, the upper part is zero
+        write_zero_digits(write, width - low_width);
+        limbs_to_decimal(write, low_width, a, n);
+        return;
+    }
+
+    // a = q * power + r, where r keeps the low `z` limbs of `a` unchanged
+    std::vector<big_limb> q(z + np + 1), r(z + np);
+    std::copy(a, a + z, r.begin());
+    divrem_pow10(q.data(), r.data() + z, a + z, n - z, power);
+
+    limbs_to_decimal(write, width - low_width, q.data(), q.size());
+    limbs_to_decimal(write, low_width, r.data(), r.size());
+}
+
+
+/*
+    decimal_to_limbs
+    ----------------
+    Returns the limbs of the value of the `length` decimal digits at `digits`.
+    Above the radix conversion threshold the digits are split in two, and
+    the value is rebuilt as upper * 10^(length of lower) + lower.
+*/
+
+std::vector<big_limb> decimal_to_limbs(const char* digits, size_t length) {
+    std::vector<big_limb> limbs;
+    if (length < big_int_thresholds.radix_conversion * DIGITS_PER_LIMB) {
+        // the first chunk takes the digits left over by the 19-digit ones
+        size_t chunk_length = length % DIGITS_PER_LIMB;
+        if (chunk_length == 0)
+            chunk_length = DIGITS_PER_LIMB;
+        limbs.reserve(length / DIGITS_PER_LIMB + 1);
+        for (size_t i = 0; i < length; i += chunk_length) {
+            if (i != 0)
+                chunk_length = DIGITS_PER_LIMB;
+            big_limb chunk = 0;
+            for (size_t j = i; j < i + chunk_length; j++)
+                chunk = chunk * 10 + (digits[j] - '0');
+
+            // value = value * 10^19 + chunk
+            big_limb carry = mul_limb(limbs.data(), limbs.data(), limbs.size(), LIMB_POW10);
+            carry += add_limb(limbs.data(), limbs.data(), limbs.size(), chunk);
+            if (carry)
+                limbs.push_back(carry);
+        }
+        return limbs;
+    }
+
+    const Pow10Limbs& power = pow10_limbs(pow10_level(length));
+    std::vector<big_limb> upper = decimal_to_limbs(digits, length - power.digits);
+    std::vector<big_limb> lower = decimal_to_limbs(digits + length - power.digits, power.digits);
+    if (upper.empty())
+        return lower;
+
+    // upper * power occupies `z` zero limbs followed by the product with the
+    // stored part, and lower < power fits in the `z` + `np` limbs below its top
+    size_t nu = upper.size();
+    size_t np = power.limbs.size();
+    size_t z = power.zero_limbs;
+    limbs.assign(z + nu + np, 0);
+    if (nu >= np)
+        mul_limbs(limbs.data() + z, upper.data(), nu, power.limbs.data(), np,
+                  mul_scratch(mul_limbs_scratch_size(nu, np)));
+    else
+        mul_limbs(limbs.data() + z, power.limbs.data(), np, upper.data(), nu,
+                  mul_scratch(mul_limbs_scratch_size(np, nu)));
+    if (!lower.empty())
+        add_limbs(limbs.data(), limbs.data(), limbs.size(), lower.data(), lower.size());
+    strip_leading_zeroes(limbs);
+
+    return limbs;
+}
+
+#endif  // BIG_INT_RADIX_CONVERSION_FUNCTIONS_HPP
+
+
+/*
+    ===========================================================================
+    Random number generating functions for BigInt
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_RANDOM_FUNCTIONS_HPP
+#define BIG_INT_RANDOM_FUNCTIONS_HPP
+
+#include <random>
+#include <climits>
+
+
+// when the number of digits are not specified, a random value is used for it
+// which is kept below the following:
+inline constexpr size_t MAX_RANDOM_LENGTH = 1000;
+
+// defined with the math functions
+BigInt big_pow10(size_t exp);
+
+
+/*
+    big_random_bits
+    ---------------
+    Returns a BigInt drawn uniformly from [0, 2^bits), filling its limbs
+    directly with the values of `generator`, which can be any uniform random
+    bit generator, such as a seeded std::mt19937_64.
+*/
+
+template <typename URBG>
+BigInt big_random_bits(size_t bits, URBG& generator) {
+    std::uniform_int_distribution<big_limb> limb_distribution;
+
+    BigInt num;
+    size_t size = (bits + 63) / 64;
+    num.limbs.resize(size);
+    for (size_t i = 0; i < size; i++)
+        num.limbs[i] = limb_distribution(generator);
+    if (bits % 64)
+        num.limbs[size - 1] &= ((big_limb) 1 << (bits % 64)) - 1;
+    strip_leading_zeroes(num.limbs);
+
+    return num;
+}
+
+
+/*
+    big_random_range
+    ----------------
+    Returns a BigInt drawn uniformly from [low, high], both included, using
+    `generator`. Values of the bit length of high - low are drawn until one
+    falls in the range, which takes less than two draws on average.
+*/
+
+template <typename URBG>
+BigInt big_random_range(const BigInt& low, const BigInt& high, URBG& generator) {
+    if (high < low)
+        throw std::invalid_argument("Empty range in big_random_range");
+
+    BigInt span = high - low;
+    size_t bits = span.bit_length();
+    BigInt offset;
+    do
+        offset = big_random_bits(bits, generator);
+    while (offset > span);
+
+    return std::move(offset) + low;
+}
+
+
+/*
+    big_random (num_digits, generator)
+    ----------------------------------
+    Returns a BigInt drawn uniformly from those with `num_digits` digits, or
+    with a random number of digits (up to MAX_RANDOM_LENGTH) when it is 0,
+    using `generator`.
+*/
+
+template <typename URBG>
+BigInt big_random(size_t num_digits, URBG& generator) {
+    if (num_digits == 0) {
+        std::uniform_int_distribution<size_t> length_distribution(1, MAX_RANDOM_LENGTH);
+        num_digits = length_distribution(generator);
+    }
+
+    BigInt low = big_pow10(num_digits - 1);
+    BigInt high = low * 10 - 1;
+
+    return big_random_range(low, high, generator);
+}
+
+
+/*
+    big_random_engine
+    -----------------
+    Returns the per-thread generator behind `big_random`, which is seeded
+    once from std::random_device instead of reading it for every value.
+*/
+
+std::mt19937_64& big_random_engine() {
+    thread_local std::mt19937_64 engine = [] {
+        std::random_device device;
+        std::seed_seq seed{device(), device(), device(), device()};
+        return std::mt19937_64(seed);
+    }();
+
+    return engine;
+}
+
+
+/*
+    big_random (num_digits)
+    -----------------------
+    Returns a random BigInt with a specific number of digits.
+*/
+
+BigInt big_random(size_t num_digits = 0) {
+    return big_random(num_digits, big_random_engine());
+}
+
+
+#endif  // BIG_INT_RANDOM_FUNCTIONS_HPP
+
+
+/*
+    ===========================================================================
+    Constructors
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_CONSTRUCTORS_HPP
+#define BIG_INT_CONSTRUCTORS_HPP
+
+
+
+/*
+    Default constructor
+    -------------------
+*/
+
+BigInt::BigInt() {
+    sign = '+';
+}
+
+
+/*
+    Copy constructor
+    ----------------
+*/
+
+BigInt::BigInt(const BigInt& num) {
+    limbs = num.limbs;
+    sign = num.sign;
+}
+
+
+/*
+    Move constructor
+    ----------------
+    Takes over the limbs of `num`, which is left as zero.
+*/
+
+BigInt::BigInt(BigInt&& num) noexcept : limbs(std::move(num.limbs)) {
+    sign = num.sign;
+    num.sign = '+';
+}
+
+
+/*
+    Integer to BigInt
+    -----------------
+*/
+
+BigInt::BigInt(const long long& num) {
+    big_limb magnitude = word_magnitude(num);
+    if (magnitude != 0)
+        limbs.push_back(magnitude);
+    if (num < 0)
+        sign = '-';
+    else
+        sign = '+';
+}
+
+
+/*
+    String to BigInt
+    ----------------
+*/
+
+BigInt::BigInt(const std::string& num) {
+    std::string magnitude;
+    if (num[0] == '+' or num[0] == '-') {     // check for sign
+        magnitude = num.substr(1);
+        sign = num[0];
+    }
+    else {      // if no sign is specified
+        magnitude = num;
+        sign = '+';    // positive by default
+    }
+    if (!is_valid_number(magnitude))
+        throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
+
+    std::vector<big_limb> magnitude_limbs = decimal_to_limbs(magnitude.data(), magnitude.size());
+    limbs.assign(magnitude_limbs.data(), magnitude_limbs.data() + magnitude_limbs.size());
+    if (limbs.empty())
+        sign = '+';
+}
+
+
+/*
+    BigIntConstant to BigInt
+    ------------------------
+    Only copies the limbs, however the constant was written.
+*/
+
+template <size_t N>
+BigInt::BigInt(const BigIntConstant<N>& num) {
+    limbs.assign(num.limbs, num.limbs + num.size);
+    sign = num.negative ? '-' : '+';
+}
+
+
+/*
+    big_from_word
+    -------------
+    Returns the non-negative BigInt with the value of `word`, which, unlike the
+    `long long` constructor, takes every value up to 2^64 - 1.
+*/
+
+BigInt big_from_word(big_limb word) {
+    BigInt num;
+    if (word != 0)
+        num.limbs.push_back(word);
+
+    return num;
+}
+
+
+/*
+    _big
+    ----
+    A literal suffix for BigInts of any length, such as
+    123456789012345678901234567890_big. The literal is converted into limbs
+    at compile time, so at runtime the BigInt is just copied from them.
+*/
+
+template <char... Digits>
+BigInt operator""_big() {
+    // at most 4 bits per character, for hexadecimal literals
+    static constexpr char digits[] = {Digits...};
+    static constexpr auto value =
+        BigIntConstant<(4 * sizeof...(Digits) + 63) / 64>::from_string({digits, sizeof...(Digits)});
+
+    return BigInt(value);
+}
+
+#endif  // BIG_INT_CONSTRUCTORS_HPP
+
+
+/*
+    ===========================================================================
+    Conversion functions for BigInt
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_CONVERSION_FUNCTIONS_HPP
+#define BIG_INT_CONVERSION_FUNCTIONS_HPP
+
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+
+/*
+    write_digits
+    ------------
+    Writes the digits of the absolute value of `num` in base 10, 16, 8 or 2,
+    without a sign or a prefix, and with uppercase letters if `uppercase` is
+    set. `start(size_t count)` is called once with the number of digits, and
+    then the digits go, from the most significant one, to
+    `write(const char* digits, size_t count)` in blocks of at most 64, so that
+    they can be sent straight to a stream or to an output iterator.
+*/
+
+template <typename Start, typename Write>
+void write_digits(const BigInt& num, int base, bool uppercase, Start start, Write write) {
+    const BigIntLimbs& limbs = num.limbs;
+    if (limbs.empty()) {
+        start(1);
+        write("0", 1);
+        return;
+    }
+
+    size_t bits = (limbs.size() - 1) * 64 + std::bit_width(limbs.back());
+    if (base == 10) {
+        // 64 * log10(2) < 19.27 decimal digits per limb, so this is never
+        // short, and the leading zeroes it leaves are skipped
+        size_t width = bits * 30103 / 100000 + 1;
+        bool started = false;
+        auto skip_zeroes = [&](const char* digits, size_t count) {
+            if (not started) {
+                size_t zeroes = 0;
+                while (zeroes < count and digits[zeroes] == '0')
+                    zeroes++;
+                width -= zeroes;
+                if (zeroes == count)
+                    return;
+                started = true;
+                start(width);
+                digits += zeroes;
+                count -= zeroes;
+            }
+            write(digits, count);
+        };
+        limbs_to_decimal(skip_zeroes, width, limbs.data(), limbs.size());
+        return;
+    }
+
+    // a power of two: every digit is a group of bits, read from the top
+    unsigned digit_bits = std::countr_zero((unsigned) base);
+    size_t width = (bits + digit_bits - 1) / digit_bits;
+    const char* symbols = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    start(width);
+    char digits[64];
+    for (size_t i = 0; i < width; i += sizeof(digits)) {
+        size_t count = std::min(width - i, sizeof(digits));
+        for (size_t j = 0; j < count; j++) {
+            size_t position = (width - 1 - i - j) * digit_bits;
+            size_t index = position / 64;
+            unsigned shift = position % 64;
+            big_limb value = limbs[index] >> shift;
+            if (shift + digit_bits > 64 and index + 1 < limbs.size())
+                value |= limbs[index + 1] << (64 - shift);
+            digits[j] = symbols[value & (base - 1)];
+        }
+        write(digits, count);
+    }
+}
+
+
+/*
+    to_string
+    ---------
+    Converts a BigInt to a string.
+*/
+
+std::string BigInt::to_string() const {
+    // prefix with sign if negative
+    std::string result = this->sign == '-' ? "-" : "";
+    write_digits(*this, 10, false,
+                 [&](size_t count) { result.reserve(result.size() + count); },
+                 [&](const char* digits, size_t count) { result.append(digits, count); });
+
+    return result;
+}
+
+
+/*
+    to_int
+    ------
+    Converts a BigInt to an int.
+    NOTE: If the BigInt is out of range of an int, an out_of_range exception is
+    thrown.
+*/
+
+int BigInt::to_int() const {
+    long long num = this->to_long_long();
+    if (num < INT_MIN or num > INT_MAX)
+        throw std::out_of_range("BigInt is out of range of an int");
+
+    return (int) num;
+}
+
+
+/*
+    to_long
+    -------
+    Converts a BigInt to a long int.
+    NOTE: If the BigInt is out of range of a long int, an out_of_range
+    exception is thrown.
+*/
+
+long BigInt::to_long() const {
+    long long num = this->to_long_long();
+    if (num < LONG_MIN or num > LONG_MAX)
+        throw std::out_of_range("BigInt is out of range of a long");
+
+    return (long) num;
+}
+
+
+/*
+    to_long_long
+    ------------
+    Converts a BigInt to a long long int.
+    NOTE: If the BigInt is out of range of a long long int, an out_of_range
+    exception is thrown.
+*/
+
+long long BigInt::to_long_long() const {
+    if (limbs.empty())
+        return 0;
+
+    big_limb limit = (big_limb) LLONG_MAX + (this->sign == '-' ? 1 : 0);
+    if (limbs.size() > 1 or limbs[0] > limit)
+        throw std::out_of_range("BigInt is out of range of a long long");
+
+    // negate in unsigned arithmetic so that LLONG_MIN does not overflow
+    return this->sign == '-' ? (long long) (0 - limbs[0]) : (long long) limbs[0];
+}
+
+/*
+    byte_size
+    ---------
+    Returns the number of bytes that `to_bytes` writes for a BigInt: a header
+    of `BYTES_HEADER_SIZE` bytes plus the magnitude, without high-order zero
+    bytes.
+*/
+
+size_t BigInt::byte_size() const {
+    if (limbs.empty())
+        return BYTES_HEADER_SIZE;
+
+    return BYTES_HEADER_SIZE + (limbs.size() - 1) * 8 + (std::bit_width(limbs.back()) + 7) / 8;
+}
+
+
+/*
+    byte_size (header)
+    ------------------
+    Returns the size of a whole encoding from its first `BYTES_HEADER_SIZE`
+    bytes, so that a reader knows how much more to read from a pipe or a
+    socket before calling `from_bytes`.
+    NOTE: If fewer bytes are given, an invalid_argument exception is thrown.
+*/
+
+size_t BigInt::byte_size(std::span<const std::byte> header) {
+    if (header.size() < BYTES_HEADER_SIZE)
+        throw std::invalid_argument("Expected a BigInt header of 8 bytes");
+
+    std::uint64_t length = 0;
+    for (size_t i = 0; i < BYTES_HEADER_SIZE; i++)
+        length |= (std::uint64_t) header[i] << (8 * i);
+
+    return BYTES_HEADER_SIZE + length / 2;
+}
+
+
+/*
+    to_bytes
+    --------
+    Writes a BigInt into `buffer` in a compact binary form and returns the
+    number of bytes written, which is `byte_size()`. The encoding starts with
+    a 64-bit little-endian header holding twice the length of the magnitude
+    in bytes, plus one for a negative number, followed by the magnitude as
+    little-endian bytes. It needs no base conversion, so large values can be
+    sent as they are through pipes, sockets or shared memory.
+    NOTE: If `buffer` is too small, a length_error exception is thrown.
+*/
+
+size_t BigInt::to_bytes(std::span<std::byte> buffer) const {
+    size_t size = byte_size();
+    if (buffer.size() < size)
+        throw std::length_error("Buffer too small for the BigInt");
+
+    std::uint64_t header = 2 * (size - BYTES_HEADER_SIZE) + (sign == '-' ? 1 : 0);
+    for (size_t i = 0; i < BYTES_HEADER_SIZE; i++)
+        buffer[i] = (std::byte) (header >> (8 * i));
+
+    std::byte* out = buffer.data() + BYTES_HEADER_SIZE;
+    size_t full_limbs = (size - BYTES_HEADER_SIZE) / 8;
+    if constexpr (std::endian::native == std::endian::little)
+        std::memcpy(out, limbs.data(), full_limbs * 8);
+    else
+        for (size_t i = 0; i < full_limbs * 8; i++)
+            out[i] = (std::byte) (limbs[i / 8] >> (8 * (i % 8)));
+    for (size_t i = full_limbs * 8; i < size - BYTES_HEADER_SIZE; i++)
+        out[i] = (std::byte) (limbs[i / 8] >> (8 * (i % 8)));
+
+    return size;
+}
+
+
+/*
+    from_bytes
+    ----------
+    Reads a BigInt written by `to_bytes` from the start of `bytes`. Any bytes
+    after the encoding are ignored.
+    NOTE: If `bytes` is shorter than the encoding, an invalid_argument
+    exception is thrown.
+*/
+
+BigInt BigInt::from_bytes(std::span<const std::byte> bytes) {
+    size_t size = byte_size(bytes);
+    if (bytes.size() < size)
+        throw std::invalid_argument("Expected " + std::to_string(size) + " bytes for the BigInt, got "
+                                    + std::to_string(bytes.size()));
+
+    const std::byte* in = bytes.data() + BYTES_HEADER_SIZE;
+    size_t length = size - BYTES_HEADER_SIZE;
+    size_t full_limbs = length / 8;
+
+    BigInt num;
+    num.limbs.resize((length + 7) / 8);
+    if constexpr (std::endian::native == std::endian::little)
+        std::memcpy(num.limbs.data(), in, full_limbs * 8);
+    else
+        for (size_t i = 0; i < full_limbs * 8; i++)
+            num.limbs[i / 8] |= (big_limb) in[i] << (8 * (i % 8));
+    for (size_t i = full_limbs * 8; i < length; i++)
+        num.limbs[i / 8] |= (big_limb) in[i] << (8 * (i % 8));
+    strip_leading_zeroes(num.limbs);
+
+    if (std::to_integer<int>(bytes[0]) % 2 == 1 and !num.limbs.empty())
+        num.sign = '-';
+
+    return num;
+}
+
+#endif  // BIG_INT_CONVERSION_FUNCTIONS_HPP
+
+
+/*
+    ===========================================================================
+    Assignment operators
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_ASSIGNMENT_OPERATORS_HPP
+#define BIG_INT_ASSIGNMENT_OPERATORS_HPP
+
+
+
+/*
+    BigInt = BigInt
+    ---------------
+*/
+
+BigInt& BigInt::operator=(const BigInt& num) {
+    limbs = num.limbs;
+    sign = num.sign;
+
+    return *this;
+}
+
+
+/*
+    BigInt = BigInt (move)
+    ----------------------
+    Takes over the limbs of `num`, which is left as zero. Limbs on the heap of
+    another memory resource are copied instead, which may allocate.
+*/
+
+BigInt& BigInt::operator=(BigInt&& num) {
+    limbs = std::move(num.limbs);
+    sign = num.sign;
+    if (this != &num)
+        num.sign = '+';
+
+    return *this;
+}
+
+
+/*
+    BigInt = Integer
+    ----------------
+*/
+
+BigInt& BigInt::operator=(const long long& num) {
+    BigInt temp(num);
+    limbs = temp.limbs;
+    sign = temp.sign;
+
+    return *this;
+}
+
+
+/*
+    BigInt = String
+    ---------------
+*/
+
+BigInt& BigInt::operator=(const std::string& num) {
+    BigInt temp(num);
+    limbs = temp.limbs;
+    sign = temp.sign;
+
+    return *this;
+}
+
+#endif  // BIG_INT_ASSIGNMENT_OPERATORS_HPP
+
+
+/*
+    ===========================================================================
+    Unary arithmetic operators
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
+#define BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
+
+
+
+/*
+    +BigInt
+    -------
+    Returns the value of a BigInt.
+    NOTE: This function does not return the absolute value. To get the absolute
+    value of a BigInt, use the `abs` function.
+*/
+
+BigInt BigInt::operator+() const {
+    return *this;
+}
+
+
+/*
+    -BigInt
+    -------
+    Returns the negative of a BigInt.
+*/
+
+BigInt BigInt::operator-() const {
+    BigInt temp;
+
+    temp.limbs = limbs;
+    if (!limbs.empty()) {
+        if (sign == '+')
+            temp.sign = '-';
+        else
+            temp.sign = '+';
+    }
+
+    return temp;
+}
+
+#endif  // BIG_INT_UNARY_ARITHMETIC_OPERATORS_HPP
+
+
+/*
+    ===========================================================================
+    Relational operators
+    ===========================================================================
+    All operators depend on the '<' and/or '==' operator(s).
+*/
+
+#ifndef BIG_INT_RELATIONAL_OPERATORS_HPP
+#define BIG_INT_RELATIONAL_OPERATORS_HPP
+
+
+
+/*
+    compare_word
+    ------------
+    Returns -1, 0 or 1 as `num` is less than, equal to or greater than `word`,
+    looking at no more than the sign and the lowest limb of `num`.
+*/
+
+int compare_word(const BigInt& num, long long word) {
+    char word_sign = word < 0 ? '-' : '+';
+    if (num.sign != word_sign)
+        return num.sign == '+' ? 1 : -1;
+
+    big_limb word_limb = word_magnitude(word);
+    int cmp;
+    if (num.limbs.size() > 1)
+        cmp = 1;
+    else {
+        big_limb limb = num.limbs.empty() ? 0 : num.limbs[0];
+        cmp = limb < word_limb ? -1 : limb > word_limb ? 1 : 0;
+    }
+
+    return num.sign == '+' ? cmp : -cmp;
+}
+
+
+/*
+    BigInt == BigInt
+    ----------------
+*/
+
+bool BigInt::operator==(const BigInt& num) const {
+    return (sign == num.sign) and (limbs == num.limbs);
+}
+
+
+/*
+    BigInt != BigInt
+    ----------------
+*/
+
+bool BigInt::operator!=(const BigInt& num) const {
+    return !(*this == num);
+}
+
+
+/*
+    BigInt < BigInt
+    ---------------
+*/
+
+bool BigInt::operator<(const BigInt& num) const {
+    if (sign == num.sign) {
+        int cmp = compare_limbs(limbs.data(), limbs.size(),
+                                num.limbs.data(), num.limbs.size());
+        return sign == '+' ? cmp < 0 : cmp > 0;
+    }
+    else
+        return sign == '-';
+}
+
+
+/*
+    BigInt > BigInt
+    ---------------
+*/
+
+bool BigInt::operator>(const BigInt& num) const {
+    return !((*this < num) or (*this == num));
+}
+
+
+/*
+    BigInt <= BigInt
+    ----------------
+*/
+
+bool BigInt::operator<=(const BigInt& num) const {
+    return (*this < num) or (*this == num);
+}
+
+
+/*
+    BigInt >= BigInt
+    ----------------
+*/
+
+bool BigInt::operator>=(const BigInt& num) const {
+    return !(*this < num);
+}
+
+
+/*
+    BigInt == Integer
+    -----------------
+*/
+
+bool BigInt::operator==(const long long& num) const {
+    return compare_word(*this, num) == 0;
+}
+
+
+/*
+    Integer == BigInt
+    -----------------
+*/
+
+bool operator==(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) == 0;
+}
+
+
+/*
+    BigInt != Integer
+    -----------------
+*/
+
+bool BigInt::operator!=(const long long& num) const {
+    return compare_word(*this, num) != 0;
+}
+
+
+/*
+    Integer != BigInt
+    -----------------
+*/
+
+bool operator!=(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) != 0;
+}
+
+
+/*
+    BigInt < Integer
+    ----------------
+*/
+
+bool BigInt::operator<(const long long& num) const {
+    return compare_word(*this, num) < 0;
+}
+
+
+/*
+    Integer < BigInt
+    ----------------
+*/
+
+bool operator<(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) > 0;
+}
+
+
+/*
+    BigInt > Integer
+    ----------------
+*/
+
+bool BigInt::operator>(const long long& num) const {
+    return compare_word(*this, num) > 0;
+}
+
+
+/*
+    Integer > BigInt
+    ----------------
+*/
+
+bool operator>(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) < 0;
+}
+
+
+/*
+    BigInt <= Integer
+    -----------------
+*/
+
+bool BigInt::operator<=(const long long& num) const {
+    return compare_word(*this, num) <= 0;
+}
+
+
+/*
+    Integer <= BigInt
+    -----------------
+*/
+
+bool operator<=(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) >= 0;
+}
+
+
+/*
+    BigInt >= Integer
+    -----------------
+*/
+
+bool BigInt::operator>=(const long long& num) const {
+    return compare_word(*this, num) >= 0;
+}
+
+
+/*
+    Integer >= BigInt
+    -----------------
+*/
+
+bool operator>=(const long long& lhs, const BigInt& rhs) {
+    return compare_word(rhs, lhs) <= 0;
+}
+
+
+/*
+    BigInt == String
+    ----------------
+*/
+
+bool BigInt::operator==(const std::string& num) const {
+    return *this == BigInt(num);
+}
+
+
+/*
+    String == BigInt
+    ----------------
+*/
+
+bool operator==(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) == rhs;
+}
+
+
+/*
+    BigInt != String
+    ----------------
+*/
+
+bool BigInt::operator!=(const std::string& num) const {
+    return !(*this == BigInt(num));
+}
+
+
+/*
+    String != BigInt
+    ----------------
+*/
+
+bool operator!=(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) != rhs;
+}
+
+
+/*
+    BigInt < String
+    ---------------
+*/
+
+bool BigInt::operator<(const std::string& num) const {
+    return *this < BigInt(num);
+}
+
+
+/*
+    String < BigInt
+    ---------------
+*/
+
+bool operator<(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) < rhs;
+}
+
+
+/*
+    BigInt > String
+    ---------------
+*/
+
+bool BigInt::operator>(const std::string& num) const {
+    return *this > BigInt(num);
+}
+
+
+/*
+    String > BigInt
+    ---------------
+*/
+
+bool operator>(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) > rhs;
+}
+
+
+/*
+    BigInt <= String
+    ----------------
+*/
+
+bool BigInt::operator<=(const std::string& num) const {
+    return !(*this > BigInt(num));
+}
+
+
+/*
+    String <= BigInt
+    ----------------
+*/
+
+bool operator<=(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) <= rhs;
+}
+
+
+/*
+    BigInt >= String
+    ----------------
+*/
+
+bool BigInt::operator>=(const std::string& num) const {
+    return !(*this < BigInt(num));
+}
+
+
+/*
+    String >= BigInt
+    ----------------
+*/
+
+bool operator>=(const std::string& lhs, const BigInt& rhs) {
+    return BigInt(lhs) >= rhs;
+}
+
+#endif  // BIG_INT_RELATIONAL_OPERATORS_HPP
+
+
+/*
+    ===========================================================================
+    Math functions for BigInt
+    ===========================================================================
+*/
+
+#ifndef BIG_INT_MATH_FUNCTIONS_HPP
+#define BIG_INT_MATH_FUNCTIONS_HPP
+
+#include <array>
+#include <bit>
+#include <climits>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+
+
+/*
+    abs
+    ---
+    Returns the absolute value of a BigInt.
+*/
+
+BigInt abs(const BigInt& num) {
+    return num < 0 ? -num : num;
+}
+
+
+/*
+    pow (BigInt)
+    ------------
+    Returns a BigInt equal to base^exp.
+*/
+
+BigInt pow(const BigInt& base, int exp) {
+    if (exp < 0) {
+        if (base == 0)
+            throw std::logic_error("Cannot divide by zero");
+        return abs(base) == 1 ? base : 0;
+    }
+    if (exp == 0) {
+        if (base == 0)
+            throw std::logic_error("Zero cannot be raised to zero");
+        return 1;
+    }
+
+    BigInt result = base, result_odd = 1;
+    while (exp > 1) {
+        if (exp % 2)
+            result_odd *= result;
+        result *= result;
+        exp /= 2;
+    }
+
+    return result * result_odd;
+}
+
+
+/*
+    pow (Integer)
+    -------------
+    Returns a BigInt equal to base^exp.
+*/
+
+BigInt pow(const long long& base, int exp) {
+    return pow(BigInt(base), exp);
+}
+
+
+/*
+    pow (String)
+    ------------
+    Returns a BigInt equal to base^exp.
+*/
+
+BigInt pow(const std::string& base, int exp) {
+    return pow(BigInt(base), exp);
+
+}
+
+
+// 10^0 to 10^38, the powers of ten that fit in two limbs, laid out by the
+// compiler
+inline constexpr auto SMALL_POW10 = [] {
+    std::array<BigIntConstant<2>, 39> table;
+    table[0] = BigIntConstant<2>(1);
+    for (size_t i = 1; i < table.size(); i++) {
+        table[i] = table[i - 1];
+        table[i].mul_add(10, 0);
+    }
+
+    return table;
+}();
+
+
+/*
+    big_pow10
+    ---------
+    Returns a BigInt equal to 10^exp. Small powers are copied from a table,
+    and larger ones are computed as 5^exp * 2^exp, which only has to raise the
+    shorter 5 to the power and then shifts the result.
+    NOTE: If exp is larger than INT_MAX, an overflow_error exception is
+    thrown.
+*/
+
+BigInt big_pow10(size_t exp) {
+    if (exp < SMALL_POW10.size())
+        return BigInt(SMALL_POW10[exp]);
+    if (exp > INT_MAX)
+        throw std::overflow_error("Exponent too large in big_pow10");
+
+    return pow(BigInt(5), (int) exp) << exp;
+}
+
+
+/*
+    sqrt
+    ----
+    Returns the positive integer square root of a BigInt, rounded down, using
+    Newton's method. The starting point is obtained recursively from the square
+    root of the top half of the bits, so it is already an overestimate with
+    about half of the bits right and only a couple of full-size divisions are
+    needed at each level.
+    NOTE: the input must be non-negative.
+*/
+
+BigInt sqrt(const BigInt& num) {
+    if (num.sign == '-')
+        throw std::invalid_argument("Cannot compute square root of a negative integer");
+
+    if (num.limbs.empty())
+        return 0;
+
+    size_t bits = (num.limbs.size() - 1) * 64 + std::bit_width(num.limbs.back());
+    BigInt sqrt_current;
+    if (num.limbs.size() <= 2) {
+        // 2^ceil(bits / 2) is never below the square root.
+        size_t root_bits = (bits + 1) / 2;
+        sqrt_current.limbs.assign(root_bits / 64 + 1, 0);
+        sqrt_current.limbs[root_bits / 64] = big_limb(1) << (root_bits % 64);
+    }
+    else {
+        // With num = top * 4^shift + low, the root of num is at most
+        // (sqrt(top) + 1) * 2^shift.
+        size_t shift = bits / 4;
+        size_t limb_shift = (2 * shift) / 64;
+        unsigned bit_shift = (2 * shift) % 64;
+
+        BigInt top;
+        top.limbs.assign(num.limbs.begin() + limb_shift, num.limbs.end());
+        if (bit_shift != 0)
+            rshift_limbs(top.limbs.data(), top.limbs.data(), top.limbs.size(), bit_shift);
+        strip_leading_zeroes(top.limbs);
+
+        BigInt root = sqrt(top);
+        root++;
+
+        limb_shift = shift / 64;
+        bit_shift = shift % 64;
+        sqrt_current.limbs.assign(limb_shift + root.limbs.size() + 1, 0);
+        std::copy(root.limbs.begin(), root.limbs.end(), sqrt_current.limbs.begin() + limb_shift);
+        if (bit_shift != 0)
+            lshift_limbs(sqrt_current.limbs.data() + limb_shift, sqrt_current.limbs.data() + limb_shift,
+                root.limbs.size() + 1, bit_shift);
+        strip_leading_zeroes(sqrt_current.limbs);
+    }
+
+    // Starting from above, the iterates decrease strictly until they reach
+    // the rounded-down root.
+    while (true) {
+        BigInt sqrt_next = num / sqrt_current;
+        sqrt_next += sqrt_current;
+        rshift_limbs(sqrt_next.limbs.data(), sqrt_next.limbs.data(), sqrt_next.limbs.size(), 1);
+        strip_leading_zeroes(sqrt_next.limbs);
+
+        if (not (sqrt_next < sqrt_current))
+            break;
+        sqrt_current = sqrt_next;
+    }
+
+    return sqrt_current;
+}
+
+
+/*
+    lehmer_top_bits
+    ---------------
+    Returns the bits of the `n`-limb number `a` from bit `shift` upwards,
+    truncated to a limb.
+*/
+
+big_limb lehmer_top_bits(const big_limb* a, size_t n, size_t shift) {
+    size_t index = shift / 64;
+    big_double_limb window = a[index];
+    if (index + 1 < n)
+        window |= (big_double_limb) a[index + 1] << 64;
+
+    return (big_limb) (window >> (shift % 64));
+}
+
+
+/*
+    lehmer_cofactors
+    ----------------
+    Runs Euclid's algorithm on the leading bits `x` >= `y` of two numbers
+    a >= b, taken at the same position and below 2^62, for as long as the
+    quotients are sure to be those of a and b themselves (Knuth's Algorithm L,
+    TAOCP 4.5.2). The steps taken are returned as cofactors: the remainders
+    reached are u0 * a + v0 * b and u1 * a + v1 * b, in that order. `v0` is
+    zero when not even one step could be taken.
+*/
+
+struct LehmerCofactors {
+    long long u0, v0, u1, v1;
+};
+
+LehmerCofactors lehmer_cofactors(big_limb x, big_limb y) {
+    // The cofactors stay within 2^62, but not all the intermediate values do.
+    __int128 a = x, b = y;
+    __int128 u0 = 1, v0 = 0, u1 = 0, v1 = 1;
+    while (b + u1 != 0 and b + v1 != 0) {
+        __int128 q = (a + u0) / (b + u1);
+        if (q != (a + v0) / (b + v1))
+            break;
+
+        __int128 t = u0 - q * u1;
+        u0 = u1;
+        u1 = t;
+        t = v0 - q * v1;
+        v0 = v1;
+        v1 = t;
+        t = a - q * b;
+        a = b;
+        b = t;
+    }
+
+    return {(long long) u0, (long long) v0, (long long) u1, (long long) v1};
+}
 
 
 /*
-    ===========================================================================
-    Relational operators
-    ===========================================================================
-    All operators depend on the '<' and/or '==' operator(s).
+    lehmer_combine
+    --------------
+    Computes the `n` limbs of r = u * a + v * b for cofactors of opposite signs
+    (or with one of them zero) from `lehmer_cofactors`, so that the result is
+    known to be a remainder between 0 and a. `r` must not overlap either
+    operand.
 */
 
-#ifndef BIG_INT_RELATIONAL_OPERATORS_HPP
-#define BIG_INT_RELATIONAL_OPERATORS_HPP
+void lehmer_combine(big_limb* r, const big_limb* a, const big_limb* b, size_t n,
+        long long u, long long v) {
+    if (u < 0 or v > 0) {
+        std::swap(a, b);
+        std::swap(u, v);
+    }
 
+    // The high limbs of u * a and -v * b are equal and cancel out.
+    mul_limb(r, a, n, (big_limb) u);
+    submul_limb(r, b, n, (big_limb) -v);
+}
 
 
 /*
-    BigInt == BigInt
-    ----------------
+    lehmer_step
+    -----------
+    Finds the cofactors of the next Lehmer step for a >= b > 0 from their
+    leading 62 bits.
 */
 
-bool BigInt::operator==(const BigInt& num) const {
-    return (sign == num.sign) and (value == num.value);
+LehmerCofactors lehmer_step(const BigIntLimbs& a, const BigIntLimbs& b) {
+    size_t n = a.size();
+    size_t bits = (n - 1) * 64 + std::bit_width(a.back());
+    size_t shift = bits > 62 ? bits - 62 : 0;
+    big_limb y = shift / 64 < b.size() ? lehmer_top_bits(b.data(), b.size(), shift) : 0;
+
+    return lehmer_cofactors(lehmer_top_bits(a.data(), n, shift), y);
 }
 
 
 /*
-    BigInt != BigInt
-    ----------------
+    lehmer_apply
+    ------------
+    Replaces a >= b > 0 with the remainders u0 * a + v0 * b and
+    u1 * a + v1 * b, building them in the limbs of `next_a` and `next_b`, which
+    are swapped in afterwards.
 */
 
-bool BigInt::operator!=(const BigInt& num) const {
-    return !(*this == num);
+void lehmer_apply(BigIntLimbs& a, BigIntLimbs& b, const LehmerCofactors& cofactors,
+        BigIntLimbs& next_a, BigIntLimbs& next_b) {
+    size_t n = a.size();
+    b.resize(n);
+    next_a.resize(n);
+    next_b.resize(n);
+    lehmer_combine(next_a.data(), a.data(), b.data(), n, cofactors.u0, cofactors.v0);
+    lehmer_combine(next_b.data(), a.data(), b.data(), n, cofactors.u1, cofactors.v1);
+    strip_leading_zeroes(next_a);
+    strip_leading_zeroes(next_b);
+    std::swap(a, next_a);
+    std::swap(b, next_b);
 }
 
 
 /*
-    BigInt < BigInt
-    ---------------
+    gcd(BigInt, BigInt)
+    -------------------
+    Returns the greatest common divisor (GCD, a.k.a. HCF) of two BigInts using
+    Lehmer's algorithm: most of Euclid's steps are worked out on the leading
+    62 bits and applied to the full numbers several at a time, with a full
+    division step only when the quotient is too large to be found that way.
+    Once the smaller number fits in a limb, the rest is done on words.
 */
 
-bool BigInt::operator<(const BigInt& num) const {
-    if (sign == num.sign) {
-        if (sign == '+') {
-            if (value.length() == num.value.length())
-                return value < num.value;
-            else
-                return value.length() < num.value.length();
+BigInt gcd(const BigInt &num1, const BigInt &num2){
+    BigInt a = abs(num1);
+    BigInt b = abs(num2);
+    if (a < b)
+        std::swap(a, b);
+
+    // base case:
+    if (b == 0)
+        return a;   // gcd(a, 0) = |a|
+
+    BigIntLimbs next_a, next_b;
+    while (b.limbs.size() > 1) {
+        LehmerCofactors cofactors = lehmer_step(a.limbs, b.limbs);
+        if (cofactors.v0 == 0) {
+            a %= b;
+            std::swap(a, b);
         }
         else
-            return -(*this) > -num;
+            lehmer_apply(a.limbs, b.limbs, cofactors, next_a, next_b);
     }
-    else
-        return sign == '-';
-}
 
+    if (b.limbs.empty())
+        return a;
 
-/*
-    BigInt > BigInt
-    ---------------
-*/
+    big_limb word = b.limbs[0];
+    assign_double_limb(b.limbs, std::gcd(mod_word(a, word), word));
 
-bool BigInt::operator>(const BigInt& num) const {
-    return !((*this < num) or (*this == num));
+    return b;
 }
 
 
 /*
-    BigInt <= BigInt
-    ----------------
+    gcd_extended
+    ------------
+    Returns the GCD g of two BigInts together with Bézout coefficients x and y
+    such that num1 * x + num2 * y = g, as a tuple (g, x, y). The coefficients
+    are the small ones of the extended Euclidean algorithm: for non-zero
+    numbers, |x| <= |num2| and |y| <= |num1|. The remainders follow Lehmer's
+    algorithm as in `gcd`, and only the coefficient of num1 is kept along the
+    way; y is found at the end with an exact division.
 */
 
-bool BigInt::operator<=(const BigInt& num) const {
-    return (*this < num) or (*this == num);
-}
+std::tuple<BigInt, BigInt, BigInt> gcd_extended(const BigInt& num1, const BigInt& num2) {
+    // a = coef_a * |num1| and b = coef_b * |num1|, modulo |num2|
+    BigInt a = abs(num1), coef_a = 1;
+    BigInt b = abs(num2), coef_b = 0;
+    if (a < b) {
+        std::swap(a, b);
+        std::swap(coef_a, coef_b);
+    }
 
+    BigIntLimbs next_a, next_b;
+    while (not b.limbs.empty()) {
+        LehmerCofactors cofactors = lehmer_step(a.limbs, b.limbs);
+        if (cofactors.v0 == 0) {
+            auto [quotient, remainder] = divmod(a, b);
+            coef_a.sub_product(quotient, coef_b);
+            a = std::move(remainder);
+            std::swap(a, b);
+            std::swap(coef_a, coef_b);
+        }
+        else {
+            lehmer_apply(a.limbs, b.limbs, cofactors, next_a, next_b);
+            BigInt coef = coef_a * cofactors.u0;
+            coef.add_product(coef_b, cofactors.v0);
+            coef_b *= cofactors.v1;
+            coef_b.add_product(coef_a, cofactors.u1);
+            coef_a = std::move(coef);
+        }
+    }
 
-/*
-    BigInt >= BigInt
-    ----------------
-*/
+    BigInt coef_num1 = num1.sign == '-' ? -coef_a : coef_a;
+    BigInt coef_num2 = 0;
+    if (not num2.limbs.empty())
+        coef_num2 = (a - coef_num1 * num1) / num2;
 
-bool BigInt::operator>=(const BigInt& num) const {
-    return !(*this < num);
+    return std::make_tuple(a, coef_num1, coef_num2);
 }
 
 
+
 /*
-    BigInt == Integer
-    -----------------
+    gcd(BigInt, Integer)
+    --------------------
 */
 
-bool BigInt::operator==(const long long& num) const {
-    return *this == BigInt(num);
+BigInt gcd(const BigInt& num1, const long long& num2){
+    return gcd(num1, BigInt(num2));
 }
 
 
 /*
-    Integer == BigInt
-    -----------------
+    gcd(BigInt, String)
+    -------------------
 */
 
-bool operator==(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) == rhs;
+BigInt gcd(const BigInt& num1, const std::string& num2){
+    return gcd(num1, BigInt(num2));
 }
 
 
 /*
-    BigInt != Integer
-    -----------------
+    gcd(Integer, BigInt)
+    --------------------
 */
 
-bool BigInt::operator!=(const long long& num) const {
-    return !(*this == BigInt(num));
+BigInt gcd(const long long& num1, const BigInt& num2){
+    return gcd(BigInt(num1), num2);
 }
 
 
 /*
-    Integer != BigInt
-    -----------------
+    gcd(String, BigInt)
+    -------------------
 */
 
-bool operator!=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) != rhs;
+BigInt gcd(const std::string& num1, const BigInt& num2){
+    return gcd(BigInt(num1), num2);
 }
 
 
 /*
-    BigInt < Integer
-    ----------------
+    lcm(BigInt, BigInt)
+    -------------------
+    Returns the least common multiple (LCM) of two BigInts. The GCD is divided
+    out of one of them before the multiplication, so the division is only as
+    long as that number.
 */
 
-bool BigInt::operator<(const long long& num) const {
-    return *this < BigInt(num);
+BigInt lcm(const BigInt& num1, const BigInt& num2) {
+    if (num1 == 0 or num2 == 0)
+        return 0;
+
+    return abs(abs(num1) / gcd(num1, num2) * num2);
 }
 
 
 /*
-    Integer < BigInt
-    ----------------
+    lcm(BigInt, Integer)
+    --------------------
 */
 
-bool operator<(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) < rhs;
+BigInt lcm(const BigInt& num1, const long long& num2){
+    return lcm(num1, BigInt(num2));
 }
 
 
 /*
-    BigInt > Integer
-    ----------------
+    lcm(BigInt, String)
+    -------------------
 */
 
-bool BigInt::operator>(const long long& num) const {
-    return *this > BigInt(num);
+BigInt lcm(const BigInt& num1, const std::string& num2){
+    return lcm(num1, BigInt(num2));
 }
 
 
 /*
-    Integer > BigInt
-    ----------------
+    lcm(Integer, BigInt)
+    --------------------
 */
 
-bool operator>(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) > rhs;
+BigInt lcm(const long long& num1, const BigInt& num2){
+    return lcm(BigInt(num1), num2);
 }
 
 
 /*
-    BigInt <= Integer
-    -----------------
+    lcm(String, BigInt)
+    -------------------
 */
 
-bool BigInt::operator<=(const long long& num) const {
-    return !(*this > BigInt(num));
+BigInt lcm(const std::string& num1, const BigInt& num2){
+    return lcm(BigInt(num1), num2);
 }
 
 
 /*
-    Integer <= BigInt
-    -----------------
+    big_product_tree
+    ----------------
+    Returns the product of factors[first, last) by multiplying the products
+    of the two halves of the range. Every multiply is then between numbers of
+    about the same size, which the subquadratic algorithms handle far better
+    than a running product growing by one small factor at a time. With more
+    than one thread, the two halves are computed in parallel, each with half
+    of the threads. Every BigInt is built on the thread that computes it, the
+    factors being copied rather than moved, so that a worker never allocates
+    from the memory resource of the calling thread (see `BigIntMemoryScope`).
 */
 
-bool operator<=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) <= rhs;
+BigInt big_product_tree(const std::vector<BigInt>& factors, size_t first, size_t last, size_t threads) {
+    if (last - first == 1)
+        return factors[first];
+    if (last - first == 2)
+        return factors[first] * factors[first + 1];
+
+    size_t middle = first + (last - first) / 2;
+    std::optional<BigInt> left, right;     // built on the thread that computes them
+    if (threads > 1)
+        run_parallel({
+            [&] { left.emplace(big_product_tree(factors, first, middle, threads / 2)); },
+            [&] { right.emplace(big_product_tree(factors, middle, last, threads - threads / 2)); },
+        }, 2);
+    else {
+        left.emplace(big_product_tree(factors, first, middle, 1));
+        right.emplace(big_product_tree(factors, middle, last, 1));
+    }
+
+    return std::move(*left) * *right;
 }
 
 
 /*
-    BigInt >= Integer
-    -----------------
+    big_product
+    -----------
+    Returns the product of the values in [first, last) as a BigInt, or 1 for
+    an empty range, multiplying them pairwise in a balanced tree: combining N
+    partial results costs about as much as a single multiply of the final
+    size. The values can be BigInts, integers (up to `long long` or
+    `unsigned long long`) or strings.
+    Up to `threads` threads share the work.
 */
 
-bool BigInt::operator>=(const long long& num) const {
-    return !(*this < BigInt(num));
+template <typename InputIt>
+BigInt big_product(InputIt first, InputIt last, size_t threads = 1) {
+    std::vector<BigInt> factors;
+    using value_type = typename std::iterator_traits<InputIt>::value_type;
+    for (; first != last; ++first) {
+        if constexpr (std::is_integral_v<value_type> and std::is_unsigned_v<value_type>)
+            factors.push_back(big_from_word(*first));
+        else if constexpr (std::is_integral_v<value_type>)
+            factors.emplace_back((long long) *first);
+        else
+            factors.emplace_back(*first);
+    }
+
+    if (factors.empty())
+        return 1;
+
+    return big_product_tree(factors, 0, factors.size(), std::max<size_t>(1, threads));
 }
 
 
 /*
-    Integer >= BigInt
-    -----------------
+    big_range_product_odd
+    ---------------------
+    Returns the product of the integers from `low` to `high`, both included
+    and none of them zero, with their factors of two removed, and adds the
+    number of factors removed to `twos`. The range is split in halves that
+    are multiplied together, on up to `threads` threads.
 */
 
-bool operator>=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) >= rhs;
+BigInt big_range_product_odd(const BigInt& low, const BigInt& high, size_t threads, size_t& twos) {
+    BigInt count = high - low + 1;
+    if (count <= 32) {
+        BigInt product = 1;
+        for (BigInt factor = low; factor <= high; ++factor) {
+            size_t zeros = factor.countr_zero();
+            twos += zeros;
+            product *= factor >> zeros;
+        }
+        return product;
+    }
+
+    BigInt middle = low + count / 2;
+    std::optional<BigInt> left, right;     // built on the thread that computes them
+    size_t left_twos = 0, right_twos = 0;
+    if (threads > 1)
+        run_parallel({
+            [&] { left.emplace(big_range_product_odd(low, middle - 1, threads / 2, left_twos)); },
+            [&] { right.emplace(big_range_product_odd(middle, high, threads - threads / 2, right_twos)); },
+        }, 2);
+    else {
+        left.emplace(big_range_product_odd(low, middle - 1, 1, left_twos));
+        right.emplace(big_range_product_odd(middle, high, 1, right_twos));
+    }
+
+    twos += left_twos + right_twos;
+    return std::move(*left) * *right;
 }
 
 
 /*
-    BigInt == String
-    ----------------
+    big_range_product
+    -----------------
+    Returns the product of all the integers from `low` to `high`, both
+    included, or 1 when `high` < `low`. As with `big_product`, the range is
+    split in halves that are multiplied together, and up to `threads` threads
+    share the work. The factors of two are kept out of the products and put
+    back with a single shift at the end, which keeps every partial product
+    smaller. For instance, n! is big_range_product(2, n).
 */
 
-bool BigInt::operator==(const std::string& num) const {
-    return *this == BigInt(num);
+BigInt big_range_product(const BigInt& low, const BigInt& high, size_t threads = 1) {
+    if (high < low)
+        return 1;
+    if (low <= 0 and high >= 0)
+        return 0;
+
+    size_t twos = 0;
+    BigInt product = big_range_product_odd(low, high, threads, twos);
+    product <<= twos;
+
+    return product;
 }
 
 
+#endif  // BIG_INT_MATH_FUNCTIONS_HPP
+
+
 /*
-    String == BigInt
-    ----------------
+    ===========================================================================
+    Modular arithmetic
+    ===========================================================================
 */
 
-bool operator==(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) == rhs;
-}
+#ifndef BIG_INT_MODULAR_ARITHMETIC_HPP
+#define BIG_INT_MODULAR_ARITHMETIC_HPP
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 
 
 /*
-    BigInt != String
+    BigIntMontgomery
     ----------------
+    A Montgomery multiplication context for an odd, positive modulus m of n
+    limbs. Residues are held as a * R mod m, with R = 2^(64n), so that each
+    product is reduced with n multiply-add passes (REDC) instead of a long
+    division. Everything that depends on m alone is worked out once, when the
+    context is built, and reused by every call on it.
 */
 
-bool BigInt::operator!=(const std::string& num) const {
-    return !(*this == BigInt(num));
-}
+class BigIntMontgomery {
+    BigInt mod;
+    big_limb inverse;           // -1 / m modulo 2^64
+    BigIntLimbs r_squared;      // R^2 mod m, over n limbs
 
+    void redc(big_limb* r, big_limb* t) const;
+    void mul(big_limb* r, const big_limb* a, const big_limb* b, big_limb* t) const;
 
-/*
-    String != BigInt
-    ----------------
-*/
+    public:
+        explicit BigIntMontgomery(const BigInt&);
 
-bool operator!=(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) != rhs;
-}
+        const BigInt& modulus() const;
+        BigInt pow(const BigInt& base, const BigInt& exp) const;
+};
 
 
 /*
-    BigInt < String
-    ---------------
+    BigIntMontgomery(BigInt)
+    ------------------------
+    NOTE: the modulus must be odd and positive.
 */
 
-bool BigInt::operator<(const std::string& num) const {
-    return *this < BigInt(num);
+BigIntMontgomery::BigIntMontgomery(const BigInt& modulus) : mod(modulus) {
+    if (mod.sign == '-' or mod.limbs.empty() or mod.limbs[0] % 2 == 0)
+        throw std::invalid_argument("Montgomery modulus must be odd and positive");
+
+    // Newton's iteration doubles the number of correct low bits each time,
+    // starting from the 3 bits that m is its own inverse to.
+    big_limb m0 = mod.limbs[0], m_inverse = m0;
+    for (int i = 0; i < 5; i++)
+        m_inverse *= 2 - m0 * m_inverse;
+    inverse = -m_inverse;
+
+    size_t n = mod.limbs.size();
+    BigInt r2;
+    r2.limbs.assign(2 * n + 1, 0);
+    r2.limbs[2 * n] = 1;
+    r2 %= mod;
+    r_squared = r2.limbs;
+    r_squared.resize(n);
 }
 
 
 /*
-    String < BigInt
-    ---------------
+    BigIntMontgomery::modulus
+    -------------------------
 */
 
-bool operator<(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) < rhs;
+const BigInt& BigIntMontgomery::modulus() const {
+    return mod;
 }
 
 
 /*
-    BigInt > String
-    ---------------
+    BigIntMontgomery::redc
+    ----------------------
+    Sets the `n` limbs of `r` to t / R mod m for a `t` of 2n limbs below m * R,
+    which is overwritten. One multiple of m per limb clears the low half of
+    `t`; the carries out of those passes are kept in the limbs they cleared
+    and added to the high half at the end.
 */
 
-bool BigInt::operator>(const std::string& num) const {
-    return *this > BigInt(num);
+void BigIntMontgomery::redc(big_limb* r, big_limb* t) const {
+    size_t n = mod.limbs.size();
+    const big_limb* m = mod.limbs.data();
+    for (size_t i = 0; i < n; i++) {
+        big_limb carry = addmul_limb(t + i, m, n, t[i] * inverse);
+        t[i] = carry;
+    }
+
+    big_limb carry = add_limbs(r, t + n, n, t, n);
+    if (carry != 0 or compare_limbs(r, n, m, n) >= 0)
+        sub_limbs(r, r, n, m, n);
 }
 
 
 /*
-    String > BigInt
-    ---------------
+    BigIntMontgomery::mul
+    ---------------------
+    Sets the `n` limbs of `r` to the Montgomery product a * b / R mod m, using
+    `t` (2n limbs) for the full product. `r` may be the same as `a` or `b`.
 */
 
-bool operator>(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) > rhs;
+void BigIntMontgomery::mul(big_limb* r, const big_limb* a, const big_limb* b, big_limb* t) const {
+    size_t n = mod.limbs.size();
+    mul_limbs(t, a, n, b, n, mul_scratch(mul_limbs_scratch_size(n, n)));
+    redc(r, t);
 }
 
 
 /*
-    BigInt <= String
-    ----------------
+    BigIntMontgomery::pow
+    ---------------------
+    Returns base^exp modulo m, in the range [0, m), by left-to-right
+    sliding-window exponentiation: the exponent is cut into windows of up to
+    `window` bits that start and end with a one, so only the odd powers of the
+    base below 2^window are precomputed and there is one multiplication per
+    window plus one squaring per bit.
+    NOTE: the exponent must be non-negative.
 */
 
-bool BigInt::operator<=(const std::string& num) const {
-    return !(*this > BigInt(num));
-}
+BigInt BigIntMontgomery::pow(const BigInt& base, const BigInt& exp) const {
+    if (exp.sign == '-')
+        throw std::invalid_argument("Cannot compute a modular power with a negative exponent");
+    if (exp.limbs.empty()) {
+        if (base == 0)
+            throw std::logic_error("Zero cannot be raised to zero");
+        return mod == 1 ? 0 : 1;
+    }
 
+    size_t n = mod.limbs.size();
+    size_t bits = (exp.limbs.size() - 1) * 64 + std::bit_width(exp.limbs.back());
+    unsigned window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 1 ? 2 : 1;
+    auto bit = [&exp](size_t i) { return (exp.limbs[i / 64] >> (i % 64)) & 1; };
+
+    std::vector<big_limb> t(2 * n);
+    BigInt reduced = base % mod;
+    if (reduced.sign == '-')
+        reduced += mod;
+    reduced.limbs.resize(n);
+
+    // powers holds base^1, base^3, ..., base^(2^window - 1), times R.
+    std::vector<big_limb> powers(n << (window - 1)), square(n);
+    mul(powers.data(), reduced.limbs.data(), r_squared.data(), t.data());
+    if (window > 1) {
+        mul(square.data(), powers.data(), powers.data(), t.data());
+        for (size_t i = 1; i < (size_t(1) << (window - 1)); i++)
+            mul(powers.data() + i * n, powers.data() + (i - 1) * n, square.data(), t.data());
+    }
 
-/*
-    String <= BigInt
-    ----------------
-*/
+    // The top bit is a one, so the first window sets the accumulator.
+    std::vector<big_limb> result(n);
+    bool started = false;
+    for (size_t i = bits; i-- > 0;) {
+        if (not bit(i)) {
+            mul(result.data(), result.data(), result.data(), t.data());
+            continue;
+        }
 
-bool operator<=(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) <= rhs;
+        size_t low = i + 1 >= window ? i + 1 - window : 0;
+        while (not bit(low))
+            low++;
+        size_t value = 0;
+        for (size_t j = i + 1; j-- > low;)
+            value = 2 * value + bit(j);
+
+        const big_limb* power = powers.data() + (value / 2) * n;
+        if (started) {
+            for (size_t j = low; j <= i; j++)
+                mul(result.data(), result.data(), result.data(), t.data());
+            mul(result.data(), result.data(), power, t.data());
+        }
+        else {
+            std::copy(power, power + n, result.begin());
+            started = true;
+        }
+        i = low;
+    }
+
+    // Multiplying by 1 takes the result out of Montgomery form.
+    std::copy(result.begin(), result.end(), t.begin());
+    std::fill(t.begin() + n, t.end(), 0);
+    BigInt power;
+    power.limbs.resize(n);
+    redc(power.limbs.data(), t.data());
+    strip_leading_zeroes(power.limbs);
+
+    return power;
 }
 
 
 /*
-    BigInt >= String
-    ----------------
+    mul_limbs_high
+    --------------
+    Computes the `na` + `nb` limbs of a * b by long multiplication, leaving
+    out the partial products that fall in the `skip` lowest limbs, along with
+    their carries. The result is at most the exact product and falls short of
+    it by less than (min(na, nb) + 1) * B^(skip + 1). `r` must not overlap
+    either operand.
 */
 
-bool BigInt::operator>=(const std::string& num) const {
-    return !(*this < BigInt(num));
+void mul_limbs_high(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, size_t skip) {
+    std::fill(r, r + na + nb, 0);
+    for (size_t i = 0; i < na; i++) {
+        size_t j = skip > i ? std::min(skip - i, nb) : 0;
+        r[i + nb] = addmul_limb(r + i + j, b + j, nb - j, a[i]);
+    }
 }
 
 
 /*
-    String >= BigInt
-    ----------------
+    mul_limbs_low
+    -------------
+    Computes the `n` lowest limbs of a * b, for `na`, `nb` >= 1, by long
+    multiplication. `r` must not overlap either operand.
 */
 
-bool operator>=(const std::string& lhs, const BigInt& rhs) {
-    return BigInt(lhs) >= rhs;
+void mul_limbs_low(big_limb* r, const big_limb* a, size_t na,
+        const big_limb* b, size_t nb, size_t n) {
+    std::fill(r, r + n, 0);
+    for (size_t i = 0; i < std::min(na, n); i++) {
+        size_t length = std::min(nb, n - i);
+        big_limb carry = addmul_limb(r + i, b, length, a[i]);
+        if (i + length < n)
+            r[i + length] = carry;
+    }
 }
 
-#endif  // BIG_INT_RELATIONAL_OPERATORS_HPP
-
 
 /*
-    ===========================================================================
-    Math functions for BigInt
-    ===========================================================================
+    BigIntBarrett
+    -------------
+    A Barrett reduction context for a non-zero modulus m of n limbs. The
+    reciprocal mu = floor(B^(2n) / m), with B = 2^64, is worked out once, when
+    the context is built; after that, a number below B^(2n) is reduced modulo
+    m with two multiplications and a few subtractions of m, instead of a long
+    division. Unlike `BigIntMontgomery`, any modulus works, and the
+    values stay in their usual form.
 */
 
-#ifndef BIG_INT_MATH_FUNCTIONS_HPP
-#define BIG_INT_MATH_FUNCTIONS_HPP
+class BigIntBarrett {
+    BigInt mod;
+    BigInt reciprocal;          // floor(B^(2n) / m)
 
-#include <string>
+    void reduce(big_limb* r, const big_limb* x, size_t nx) const;
+
+    public:
+        explicit BigIntBarrett(const BigInt&);
 
+        const BigInt& modulus() const;
+        BigInt reduce(const BigInt&) const;
+        BigInt mulmod(const BigInt&, const BigInt&) const;
+        BigInt addmod(const BigInt&, const BigInt&) const;
+};
 
 
 /*
-    abs
-    ---
-    Returns the absolute value of a BigInt.
+    BigIntBarrett(BigInt)
+    ---------------------
+    The context works modulo the absolute value of `modulus`.
+    NOTE: the modulus must not be zero.
 */
 
-BigInt abs(const BigInt& num) {
-    return num < 0 ? -num : num;
+BigIntBarrett::BigIntBarrett(const BigInt& modulus) : mod(abs(modulus)) {
+    if (mod.limbs.empty())
+        throw std::logic_error("Attempted division by zero");
+
+    size_t n = mod.limbs.size();
+    BigInt power;
+    power.limbs.assign(2 * n + 1, 0);
+    power.limbs[2 * n] = 1;
+    reciprocal = power / mod;
 }
 
 
 /*
-    big_pow10
-    ---------
-    Returns a BigInt equal to 10^exp.
-    NOTE: exponent should be a non-negative integer.
+    BigIntBarrett::modulus
+    ----------------------
 */
 
-BigInt big_pow10(size_t exp) {
-    return BigInt("1" + std::string(exp, '0'));
+const BigInt& BigIntBarrett::modulus() const {
+    return mod;
 }
 
 
 /*
-    pow (BigInt)
-    ------------
-    Returns a BigInt equal to base^exp.
+    BigIntBarrett::reduce (limbs)
+    -----------------------------
+    Sets the `n` limbs of `r` to x mod m for an `x` of `nx` <= 2n limbs. With
+    q = floor(floor(x / B^(n-1)) * mu / B^(n+1)), which falls short of
+    floor(x / m) by at most three, x - q * m is worked out modulo B^(n+1) from
+    the low limbs of both terms and then brought below m. The products go to
+    the per-thread multiplication scratch area.
+    NOTE: `r` may overlap `x`, as when a remainder is reduced in place on top
+    of the next limbs: `x` is only read before `r` is written, and a short
+    `x` is moved with memmove.
 */
 
-BigInt pow(const BigInt& base, int exp) {
-    if (exp < 0) {
-        if (base == 0)
-            throw std::logic_error("Cannot divide by zero");
-        return abs(base) == 1 ? base : 0;
+void BigIntBarrett::reduce(big_limb* r, const big_limb* x, size_t nx) const {
+    size_t n = mod.limbs.size();
+    const big_limb* m = mod.limbs.data();
+    while (nx > 0 and x[nx - 1] == 0)
+        nx--;
+
+    if (compare_limbs(x, nx, m, n) < 0) {
+        std::memmove(r, x, nx * sizeof(big_limb));
+        std::fill(r + nx, r + n, 0);
+        return;
     }
-    if (exp == 0) {
-        if (base == 0)
-            throw std::logic_error("Zero cannot be raised to zero");
-        return 1;
+
+    // q1 = x / B^(n-1), q2 = q1 * mu and q3 = q2 / B^(n+1)
+    const big_limb* q1 = x + n - 1;
+    const big_limb* mu = reciprocal.limbs.data();
+    size_t nq1 = nx - n + 1, nmu = reciprocal.limbs.size();
+    size_t nq2 = nq1 + nmu;
+    size_t nq3 = nq2 > n + 1 ? nq2 - (n + 1) : 0;
+    bool long_multiplication = n < big_int_thresholds.toom3;
+    size_t scratch_size = long_multiplication ? 0 : std::max(
+        mul_limbs_scratch_size(std::max(nq1, nmu), std::min(nq1, nmu)),
+        nq3 ? mul_limbs_scratch_size(std::max(nq3, n), std::min(nq3, n)) : 0);
+
+    big_limb* q2 = mul_scratch(nq2 + (nq3 + n) + (n + 1) + scratch_size);
+    big_limb* product = q2 + nq2;
+    big_limb* remainder = product + nq3 + n;
+    big_limb* scratch = remainder + n + 1;
+
+    // Up to the Toom-3 range, long multiplication of just the parts that
+    // matter beats full products: the low limbs of q2 shift q3 by one at
+    // most, and only q3 * m mod B^(n+1) is needed.
+    if (long_multiplication)
+        mul_limbs_high(q2, q1, nq1, mu, nmu, n - 1);
+    else if (nq1 >= nmu)
+        mul_limbs(q2, q1, nq1, mu, nmu, scratch);
+    else
+        mul_limbs(q2, mu, nmu, q1, nq1, scratch);
+
+    // r = (x - q3 * m) mod B^(n+1), which is below 4m
+    std::fill(remainder, remainder + n + 1, 0);
+    std::copy(x, x + std::min(nx, n + 1), remainder);
+    if (nq3 > 0) {
+        const big_limb* q3 = q2 + n + 1;
+        size_t size = std::min(nq3 + n, n + 1);
+        if (long_multiplication)
+            mul_limbs_low(product, q3, nq3, m, n, size);
+        else if (nq3 >= n)
+            mul_limbs(product, q3, nq3, m, n, scratch);
+        else
+            mul_limbs(product, m, n, q3, nq3, scratch);
+        sub_limbs(remainder, remainder, n + 1, product, size);
     }
 
-    BigInt result = base, result_odd = 1;
-    while (exp > 1) {
-        if (exp % 2)
-            result_odd *= result;
-        result *= result;
-        exp /= 2;
+    size_t size = n + 1;
+    while (size > 0 and remainder[size - 1] == 0)
+        size--;
+    while (compare_limbs(remainder, size, m, n) >= 0) {
+        sub_limbs(remainder, remainder, size, m, n);
+        while (size > 0 and remainder[size - 1] == 0)
+            size--;
     }
 
-    return result * result_odd;
+    std::copy(remainder, remainder + n, r);
 }
 
 
 /*
-    pow (Integer)
-    -------------
-    Returns a BigInt equal to base^exp.
+    BigIntBarrett::reduce
+    ---------------------
+    Returns `num` modulo m in the range [0, m). Numbers of more than 2n limbs
+    are reduced n limbs at a time, from the top.
 */
 
-BigInt pow(const long long& base, int exp) {
-    return pow(BigInt(base), exp);
+BigInt BigIntBarrett::reduce(const BigInt& num) const {
+    size_t n = mod.limbs.size(), nx = num.limbs.size();
+    const big_limb* x = num.limbs.data();
+
+    BigInt result;
+    result.limbs.resize(n);
+    if (nx <= 2 * n)
+        reduce(result.limbs.data(), x, nx);
+    else {
+        // the remainder so far, below m, goes on top of the next n limbs and
+        // is reduced in place together with them
+        std::vector<big_limb> window(2 * n);
+        size_t i = nx - 2 * n;
+        reduce(window.data() + n, x + i, 2 * n);
+        while (i > 0) {
+            size_t chunk = std::min(i, n);
+            i -= chunk;
+            std::copy(x + i, x + i + chunk, window.data() + n - chunk);
+            reduce(window.data() + n, window.data() + n - chunk, n + chunk);
+        }
+        std::copy(window.begin() + n, window.end(), result.limbs.begin());
+    }
+    strip_leading_zeroes(result.limbs);
+
+    if (num.sign == '-' and not result.limbs.empty())
+        return mod - result;
+
+    return result;
 }
 
 
 /*
-    pow (String)
-    ------------
-    Returns a BigInt equal to base^exp.
+    BigIntBarrett::mulmod
+    ---------------------
+    Returns lhs * rhs modulo m in the range [0, m). Operands outside of that
+    range are reduced first, so that the product stays below B^(2n).
 */
 
-BigInt pow(const std::string& base, int exp) {
-    return pow(BigInt(base), exp);
+BigInt BigIntBarrett::mulmod(const BigInt& lhs, const BigInt& rhs) const {
+    auto in_range = [this](const BigInt& num) {
+        return num.sign == '+' and num < mod;
+    };
 
+    BigInt product = (in_range(lhs) ? lhs : reduce(lhs)) * (in_range(rhs) ? rhs : reduce(rhs));
+
+    return reduce(product);
 }
 
 
 /*
-    sqrt
-    ----
-    Returns the positive integer square root of a BigInt using Newton's method.
-    NOTE: the input must be non-negative.
+    BigIntBarrett::addmod
+    ---------------------
+    Returns lhs + rhs modulo m in the range [0, m). For operands already in
+    that range it takes a single subtraction at most.
 */
 
-BigInt sqrt(const BigInt& num) {
-    if (num < 0)
-        throw std::invalid_argument("Cannot compute square root of a negative integer");
-
-    // Optimisations for small inputs:
-    if (num == 0)
-        return 0;
-    else if (num < 4)
-        return 1;
-    else if (num < 9)
-        return 2;
-    else if (num < 16)
-        return 3;
-
-    BigInt sqrt_prev = -1;
-    // The value for `sqrt_current` is chosen close to that of the actual
-    // square root.
-    // Since a number's square root has at least one less than half as many
-    // digits as the number,
-    //     sqrt_current = 10^(half_the_digits_in_num - 1)
-    BigInt sqrt_current = big_pow10(num.to_string().size() / 2 - 1);
+BigInt BigIntBarrett::addmod(const BigInt& lhs, const BigInt& rhs) const {
+    auto in_range = [this](const BigInt& num) {
+        return num.sign == '+' and num < mod;
+    };
 
-    while (abs(sqrt_current - sqrt_prev) > 1) {
-        sqrt_prev = sqrt_current;
-        sqrt_current = (num / sqrt_prev + sqrt_prev) / 2;
-    }
+    BigInt sum = in_range(lhs) ? lhs : reduce(lhs);
+    sum += in_range(rhs) ? rhs : reduce(rhs);
+    if (sum >= mod)
+        sum -= mod;
 
-    return sqrt_current;
+    return sum;
 }
 
 
 /*
-    gcd(BigInt, BigInt)
-    -------------------
-    Returns the greatest common divisor (GCD, a.k.a. HCF) of two BigInts using
-    Euclid's algorithm.
+    powmod
+    ------
+    Returns base^exp modulo |mod| as a BigInt in the range [0, |mod|), without
+    ever building base^exp. Odd moduli use a `BigIntMontgomery` context, which
+    should be built once and used directly when many powers are taken modulo
+    the same number. Even moduli fall back to square-and-multiply with a
+    `BigIntBarrett` reduction after each step.
+    NOTE: the exponent must be non-negative.
 */
 
-BigInt gcd(const BigInt &num1, const BigInt &num2){
-    BigInt abs_num1 = abs(num1);
-    BigInt abs_num2 = abs(num2);
+BigInt powmod(const BigInt& base, const BigInt& exp, const BigInt& mod) {
+    if (mod.limbs.empty())
+        throw std::logic_error("Attempted division by zero");
 
-    // base cases:
-    if (abs_num2 == 0)
-        return abs_num1;    // gcd(a, 0) = |a|
-    if (abs_num1 == 0)
-        return abs_num2;    // gcd(0, a) = |a|
+    BigInt modulus = abs(mod);
+    if (modulus.limbs[0] % 2 == 1)
+        return BigIntMontgomery(modulus).pow(base, exp);
 
-    BigInt remainder = abs_num2;
-    while (remainder != 0) {
-        remainder = abs_num1 % abs_num2;
-        abs_num1 = abs_num2;    // previous remainder
-        abs_num2 = remainder;   // current remainder
+    if (exp.sign == '-')
+        throw std::invalid_argument("Cannot compute a modular power with a negative exponent");
+    if (exp.limbs.empty()) {
+        if (base == 0)
+            throw std::logic_error("Zero cannot be raised to zero");
+        return 1;   // an even modulus is at least 2
     }
 
-    return abs_num1;
-}
-
+    BigIntBarrett barrett(modulus);
+    BigInt reduced = barrett.reduce(base);
 
-/*
-    gcd(BigInt, Integer)
-    --------------------
-*/
+    BigInt result = reduced;
+    size_t bits = (exp.limbs.size() - 1) * 64 + std::bit_width(exp.limbs.back());
+    for (size_t i = bits - 1; i-- > 0;) {
+        result = barrett.mulmod(result, result);
+        if ((exp.limbs[i / 64] >> (i % 64)) & 1)
+            result = barrett.mulmod(result, reduced);
+    }
 
-BigInt gcd(const BigInt& num1, const long long& num2){
-    return gcd(num1, BigInt(num2));
+    return result;
 }
 
 
-/*
-    gcd(BigInt, String)
-    -------------------
-*/
-
-BigInt gcd(const BigInt& num1, const std::string& num2){
-    return gcd(num1, BigInt(num2));
-}
+#endif  // BIG_INT_MODULAR_ARITHMETIC_HPP
 
 
 /*
-    gcd(Integer, BigInt)
-    --------------------
+    ===========================================================================
+    Binary arithmetic operators
+    ===========================================================================
 */
 
-BigInt gcd(const long long& num1, const BigInt& num2){
-    return gcd(BigInt(num1), num2);
-}
+#ifndef BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
+#define BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
+
+#include <algorithm>
 
 
 /*
-    gcd(String, BigInt)
-    -------------------
+    add_signed
+    ----------
+    Computes result = lhs + rhs, with the sign of `rhs` taken to be
+    `rhs_sign`, in a single pass over the limbs. `result` may be the same
+    object as either operand, in which case its buffer is reused in place.
 */
 
-BigInt gcd(const std::string& num1, const BigInt& num2){
-    return gcd(BigInt(num1), num2);
-}
+void add_signed(BigInt& result, const BigInt& lhs, const BigInt& rhs, char rhs_sign) {
+    size_t lhs_size = lhs.limbs.size(), rhs_size = rhs.limbs.size();
 
+    if (lhs.sign == rhs_sign) {
+        // identify the numbers as `larger` and `smaller`
+        bool lhs_larger = lhs_size >= rhs_size;
+        size_t larger_size = lhs_larger ? lhs_size : rhs_size;
+        size_t smaller_size = lhs_larger ? rhs_size : lhs_size;
+
+        // the buffer may belong to an operand, so take the pointers after resizing
+        result.limbs.resize(larger_size);
+        const big_limb* larger = lhs_larger ? lhs.limbs.data() : rhs.limbs.data();
+        const big_limb* smaller = lhs_larger ? rhs.limbs.data() : lhs.limbs.data();
+        big_limb carry = add_limbs(result.limbs.data(), larger, larger_size,
+                                   smaller, smaller_size);
+        if (carry)
+            result.limbs.push_back(carry);
+
+        // the result has the common sign of the operands
+        result.sign = rhs_sign;
+        return;
+    }
 
-/*
-    lcm(BigInt, BigInt)
-    -------------------
-    Returns the least common multiple (LCM) of two BigInts.
-*/
+    // if the operands are of opposite signs, subtract the smaller magnitude
+    // from the larger one
+    int cmp = compare_limbs(lhs.limbs.data(), lhs_size, rhs.limbs.data(), rhs_size);
+    if (cmp == 0) {
+        result.limbs.clear();
+        result.sign = '+';
+        return;
+    }
+    size_t larger_size = cmp > 0 ? lhs_size : rhs_size;
+    size_t smaller_size = cmp > 0 ? rhs_size : lhs_size;
 
-BigInt lcm(const BigInt& num1, const BigInt& num2) {
-    if (num1 == 0 or num2 == 0)
-        return 0;
+    result.limbs.resize(larger_size);
+    const big_limb* larger = cmp > 0 ? lhs.limbs.data() : rhs.limbs.data();
+    const big_limb* smaller = cmp > 0 ? rhs.limbs.data() : lhs.limbs.data();
+    sub_limbs(result.limbs.data(), larger, larger_size, smaller, smaller_size);
+    strip_leading_zeroes(result.limbs);
 
-    return abs(num1 * num2) / gcd(num1, num2);
+    // the result has the sign of the operand with the larger magnitude
+    result.sign = cmp > 0 ? lhs.sign : rhs_sign;
 }
 
 
 /*
-    lcm(BigInt, Integer)
-    --------------------
+    add_word
+    --------
+    Computes result = lhs + word, with the word given by its magnitude and
+    `word_sign`, in a single pass over the limbs of `lhs`. `result` may be the
+    same object as `lhs`.
 */
 
-BigInt lcm(const BigInt& num1, const long long& num2){
-    return lcm(num1, BigInt(num2));
+void add_word(BigInt& result, const BigInt& lhs, big_limb word, char word_sign) {
+    size_t size = lhs.limbs.size();
+    char lhs_sign = lhs.sign;
+    if (size == 0) {
+        assign_double_limb(result.limbs, word);
+        result.sign = word == 0 ? '+' : word_sign;
+        return;
+    }
+
+    result.limbs.resize(size);
+    if (word == 0) {
+        if (&result != &lhs)
+            std::copy(lhs.limbs.begin(), lhs.limbs.end(), result.limbs.begin());
+        result.sign = lhs_sign;
+    }
+    else if (lhs_sign == word_sign) {
+        big_limb carry = add_limb(result.limbs.data(), lhs.limbs.data(), size, word);
+        if (carry)
+            result.limbs.push_back(carry);
+        result.sign = lhs_sign;
+    }
+    else if (size == 1 and lhs.limbs[0] < word) {
+        result.limbs[0] = word - lhs.limbs[0];
+        result.sign = word_sign;
+    }
+    else {
+        sub_limbs(result.limbs.data(), lhs.limbs.data(), size, &word, 1);
+        strip_leading_zeroes(result.limbs);
+        result.sign = result.limbs.empty() ? '+' : lhs_sign;
+    }
 }
 
 
 /*
-    lcm(BigInt, String)
-    -------------------
+    mul_word
+    --------
+    Computes result = lhs * word, with the word given by its magnitude and
+    `word_sign`, in a single pass over the limbs of `lhs`. `result` may be the
+    same object as `lhs`.
 */
 
-BigInt lcm(const BigInt& num1, const std::string& num2){
-    return lcm(num1, BigInt(num2));
+void mul_word(BigInt& result, const BigInt& lhs, big_limb word, char word_sign) {
+    size_t size = lhs.limbs.size();
+    if (size == 0 or word == 0) {
+        result.limbs.clear();
+        result.sign = '+';
+        return;
+    }
+
+    result.sign = lhs.sign == word_sign ? '+' : '-';
+    result.limbs.resize(size);
+    big_limb carry = mul_limb(result.limbs.data(), lhs.limbs.data(), size, word);
+    if (carry)
+        result.limbs.push_back(carry);
 }
 
 
 /*
-    lcm(Integer, BigInt)
-    --------------------
+    add_product_word
+    ----------------
+    Computes result += lhs * word, with the sign of the product taken to be
+    `product_sign`, in a single pass over the limbs of `lhs` and in the
+    buffer of `result`, so that no product is ever built. When the product
+    has the larger magnitude, the subtraction borrows out of the top limb
+    and the limbs are negated back into a magnitude. `lhs` may be the same
+    object as `result`.
 */
 
-BigInt lcm(const long long& num1, const BigInt& num2){
-    return lcm(BigInt(num1), num2);
+void add_product_word(BigInt& result, const BigInt& lhs, big_limb word, char product_sign) {
+    size_t n = lhs.limbs.size(), size = result.limbs.size();
+    if (n == 0 or word == 0)
+        return;
+
+    // the buffer may belong to `lhs`, so take the pointers after resizing
+    if (size == 0 or result.sign == product_sign) {
+        size = std::max(size, n) + 1;
+        result.limbs.resize(size);
+        big_limb* r = result.limbs.data();
+        big_limb carry = addmul_limb(r, lhs.limbs.data(), n, word);
+        add_limb(r + n, r + n, size - n, carry);
+        result.sign = product_sign;
+    }
+    else {
+        size = std::max(size, n + 1);
+        result.limbs.resize(size);
+        big_limb* r = result.limbs.data();
+        big_limb borrow = submul_limb(r, lhs.limbs.data(), n, word);
+        if (sub_limbs(r + n, r + n, size - n, &borrow, 1)) {
+            negate_limbs(r, size);
+            result.sign = product_sign;
+        }
+    }
+
+    strip_leading_zeroes(result.limbs);
+    if (result.limbs.empty())
+        result.sign = '+';
 }
 
 
 /*
-    lcm(String, BigInt)
-    -------------------
+    add_product_signed
+    ------------------
+    Computes result += lhs * rhs, with the sign of the product taken to be
+    `product_sign`. The product goes into the per-thread scratch area and is
+    added to or subtracted from the limbs of `result` in place, so that
+    accumulating products does not allocate once `result` is large enough.
+    Single-limb factors take the `add_product_word` path. Either operand may
+    be the same object as `result`.
 */
 
-BigInt lcm(const std::string& num1, const BigInt& num2){
-    return lcm(BigInt(num1), num2);
-}
+void add_product_signed(BigInt& result, const BigInt& lhs, const BigInt& rhs, char product_sign) {
+    size_t lhs_size = lhs.limbs.size(), rhs_size = rhs.limbs.size();
+    if (lhs_size == 0 or rhs_size == 0)
+        return;
+    if (rhs_size == 1) {
+        add_product_word(result, lhs, rhs.limbs[0], product_sign);
+        return;
+    }
+    if (lhs_size == 1) {
+        add_product_word(result, rhs, lhs.limbs[0], product_sign);
+        return;
+    }
 
+    // identify the numbers as `larger` and `smaller`
+    const BigIntLimbs& larger = lhs_size >= rhs_size ? lhs.limbs : rhs.limbs;
+    const BigIntLimbs& smaller = lhs_size >= rhs_size ? rhs.limbs : lhs.limbs;
+
+    size_t np = lhs_size + rhs_size;
+    big_limb* product = mul_scratch(np + mul_limbs_scratch_size(larger.size(), smaller.size()));
+    mul_limbs_parallel(product, larger.data(), larger.size(),
+                       smaller.data(), smaller.size(), product + np);
+    if (product[np - 1] == 0)
+        np--;
+
+    // the sum or difference of the magnitudes, with the product as a raw
+    // operand, in the same way as `add_signed`
+    size_t size = result.limbs.size();
+    if (size == 0 or result.sign == product_sign) {
+        big_limb carry;
+        if (size >= np)
+            carry = add_limbs(result.limbs.data(), result.limbs.data(), size, product, np);
+        else {
+            result.limbs.resize(np);
+            carry = add_limbs(result.limbs.data(), product, np, result.limbs.data(), size);
+        }
+        if (carry)
+            result.limbs.push_back(carry);
+        result.sign = product_sign;
+        return;
+    }
 
-#endif  // BIG_INT_MATH_FUNCTIONS_HPP
+    int cmp = compare_limbs(result.limbs.data(), size, product, np);
+    if (cmp == 0) {
+        result.limbs.clear();
+        result.sign = '+';
+        return;
+    }
+    if (cmp > 0)
+        sub_limbs(result.limbs.data(), result.limbs.data(), size, product, np);
+    else {
+        result.limbs.resize(np);
+        sub_limbs(result.limbs.data(), product, np, result.limbs.data(), size);
+        result.sign = product_sign;
+    }
+    strip_leading_zeroes(result.limbs);
+}
 
 
 /*
-    ===========================================================================
-    Binary arithmetic operators
-    ===========================================================================
+    divmod_word
+    -----------
+    Sets `quotient` to dividend / divisor, truncated towards zero, for a
+    non-zero divisor given by its magnitude, and returns the magnitude of the
+    remainder. The quotient takes the sign of the dividend, which the caller
+    flips for a negative divisor. `quotient` may be the same object as
+    `dividend`.
 */
 
-#ifndef BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
-#define BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
+big_limb divmod_word(BigInt& quotient, const BigInt& dividend, big_limb divisor) {
+    size_t size = dividend.limbs.size();
+    char dividend_sign = dividend.sign;
+    quotient.limbs.resize(size);
+    big_limb remainder = divmod_limb(quotient.limbs.data(), dividend.limbs.data(), size, divisor);
+    strip_leading_zeroes(quotient.limbs);
+    quotient.sign = quotient.limbs.empty() ? '+' : dividend_sign;
 
-#include <climits>
-#include <cmath>
-#include <string>
+    return remainder;
+}
 
 
-const long long FLOOR_SQRT_LLONG_MAX = 3037000499;
+/*
+    mod_word
+    --------
+    Returns the magnitude of num % divisor for a non-zero divisor given by its
+    magnitude, in a single pass and without building the quotient.
+*/
+
+big_limb mod_word(const BigInt& num, big_limb divisor) {
+    return mod_limb(num.limbs.data(), num.limbs.size(), divisor);
+}
 
 
 /*
@@ -1125,38 +4760,12 @@ const long long FLOOR_SQRT_LLONG_MAX = 3037000499;
     The operand on the RHS of the addition is `num`.
 */
 
-BigInt BigInt::operator+(const BigInt& num) const {
-    // if the operands are of opposite signs, perform subtraction
-    if (this->sign == '+' and num.sign == '-') {
-        BigInt rhs = num;
-        rhs.sign = '+';
-        return *this - rhs;
-    }
-    else if (this->sign == '-' and num.sign == '+') {
-        BigInt lhs = *this;
-        lhs.sign = '+';
-        return -(lhs - num);
-    }
-
-    // identify the numbers as `larger` and `smaller`
-    std::string larger, smaller;
-    std::tie(larger, smaller) = get_larger_and_smaller(this->value, num.value);
-
+BigInt BigInt::operator+(const BigInt& num) const& {
     BigInt result;      // the resultant sum
-    result.value = "";  // the value is cleared as the digits will be appended
-    short carry = 0, sum;
-    // add the two values
-    for (long i = static_cast<long>(larger.size()) - 1; i >= 0; i--) {
-        sum = larger[i] - '0' + smaller[i] - '0' + carry;
-        result.value = std::to_string(sum % 10) + result.value;
-        carry = sum / (short) 10;
-    }
-    if (carry)
-        result.value = std::to_string(carry) + result.value;
-
-    // if the operands are negative, the result is negative
-    if (this->sign == '-' and result.value != "0")
-        result.sign = '-';
+    size_t size = std::max(this->limbs.size(), num.limbs.size());
+    if (size > 2)       // a result of up to 128 bits may still fit inline
+        result.limbs.reserve(size + 1);
+    add_signed(result, *this, num, num.sign);
 
     return result;
 }
@@ -1168,66 +4777,12 @@ BigInt BigInt::operator+(const BigInt& num) const {
     The operand on the RHS of the subtraction is `num`.
 */
 
-BigInt BigInt::operator-(const BigInt& num) const {
-    // if the operands are of opposite signs, perform addition
-    if (this->sign == '+' and num.sign == '-') {
-        BigInt rhs = num;
-        rhs.sign = '+';
-        return *this + rhs;
-    }
-    else if (this->sign == '-' and num.sign == '+') {
-        BigInt lhs = *this;
-        lhs.sign = '+';
-        return -(lhs + num);
-    }
-
+BigInt BigInt::operator-(const BigInt& num) const& {
     BigInt result;      // the resultant difference
-    // identify the numbers as `larger` and `smaller`
-    std::string larger, smaller;
-    if (abs(*this) > abs(num)) {
-        larger = this->value;
-        smaller = num.value;
-
-        if (this->sign == '-')      // -larger - -smaller = -result
-            result.sign = '-';
-    }
-    else {
-        larger = num.value;
-        smaller = this->value;
-
-        if (num.sign == '+')        // smaller - larger = -result
-            result.sign = '-';
-    }
-    // pad the smaller number with zeroes
-    add_leading_zeroes(smaller, larger.size() - smaller.size());
-
-    result.value = "";  // the value is cleared as the digits will be appended
-    short difference;
-    long i, j;
-    // subtract the two values
-    for (i = static_cast<long>(larger.size()) - 1; i >= 0; i--) {
-        difference = larger[i] - smaller[i];
-        if (difference < 0) {
-            for (j = i - 1; j >= 0; j--) {
-                if (larger[j] != '0') {
-                    larger[j]--;    // borrow from the j-th digit
-                    break;
-                }
-            }
-            j++;
-            while (j != i) {
-                larger[j] = '9';    // add the borrow and take away 1
-                j++;
-            }
-            difference += 10;   // add the borrow
-        }
-        result.value = std::to_string(difference) + result.value;
-    }
-    strip_leading_zeroes(result.value);
-
-    // if the result is 0, set its sign as +
-    if (result.value == "0")
-        result.sign = '+';
+    size_t size = std::max(this->limbs.size(), num.limbs.size());
+    if (size > 2)       // a result of up to 128 bits may still fit inline
+        result.limbs.reserve(size + 1);
+    add_signed(result, *this, num, num.sign == '+' ? '-' : '+');
 
     return result;
 }
@@ -1236,66 +4791,32 @@ BigInt BigInt::operator-(const BigInt& num) const {
 /*
     BigInt * BigInt
     ---------------
-    Computes the product of two BigInts using Karatsuba's algorithm.
+    Computes the product of two BigInts with the multiplication engine, which
+    chooses between long multiplication, Karatsuba, Toom-Cook 3-way and the
+    NTT by the size of the operands, and spreads huge products over threads.
     The operand on the RHS of the product is `num`.
 */
 
-BigInt BigInt::operator*(const BigInt& num) const {
-    if (*this == 0 or num == 0)
+BigInt BigInt::operator*(const BigInt& num) const& {
+    if (this->limbs.empty() or num.limbs.empty())
         return BigInt(0);
-    if (*this == 1)
-        return num;
-    if (num == 1)
-     return *this;
+
+    // identify the numbers as `larger` and `smaller`
+    const BigIntLimbs& larger =
+        this->limbs.size() >= num.limbs.size() ? this->limbs : num.limbs;
+    const BigIntLimbs& smaller =
+        this->limbs.size() >= num.limbs.size() ? num.limbs : this->limbs;
 
     BigInt product;
-    if (abs(*this) <= FLOOR_SQRT_LLONG_MAX and abs(num) <= FLOOR_SQRT_LLONG_MAX)
-        product = std::stoll(this->value) * std::stoll(num.value);
-    else if (is_power_of_10(this->value)){ // if LHS is a power of 10 do optimised operation 
-        product.value = num.value;
-        product.value.append(this->value.begin() + 1, this->value.end());
-    }
-    else if (is_power_of_10(num.value)){ // if RHS is a power of 10 do optimised operation 
-        product.value = this->value;
-        product.value.append(num.value.begin() + 1, num.value.end());
-    }
+    if (larger.size() == 1)     // the product fits in the inline limbs
+        assign_double_limb(product.limbs, (big_double_limb) larger[0] * smaller[0]);
     else {
-        // identify the numbers as `larger` and `smaller`
-        std::string larger, smaller;
-        std::tie(larger, smaller) = get_larger_and_smaller(this->value, num.value);
-
-        size_t half_length = larger.size() / 2;
-        auto half_length_ceil = (size_t) ceil(larger.size() / 2.0);
-
-        BigInt num1_high, num1_low;
-        num1_high = larger.substr(0, half_length);
-        num1_low = larger.substr(half_length);
-
-        BigInt num2_high, num2_low;
-        num2_high = smaller.substr(0, half_length);
-        num2_low = smaller.substr(half_length);
-
-        strip_leading_zeroes(num1_high.value);
-        strip_leading_zeroes(num1_low.value);
-        strip_leading_zeroes(num2_high.value);
-        strip_leading_zeroes(num2_low.value);
-
-        BigInt prod_high, prod_mid, prod_low;
-        prod_high = num1_high * num2_high;
-        prod_low = num1_low * num2_low;
-        prod_mid = (num1_high + num1_low) * (num2_high + num2_low)
-                   - prod_high - prod_low;
-
-        add_trailing_zeroes(prod_high.value, 2 * half_length_ceil);
-        add_trailing_zeroes(prod_mid.value, half_length_ceil);
-
-        strip_leading_zeroes(prod_high.value);
-        strip_leading_zeroes(prod_mid.value);
-        strip_leading_zeroes(prod_low.value);
-
-        product = prod_high + prod_mid + prod_low;
+        product.limbs.resize(larger.size() + smaller.size());
+        big_limb* scratch = mul_scratch(mul_limbs_scratch_size(larger.size(), smaller.size()));
+        mul_limbs_parallel(product.limbs.data(), larger.data(), larger.size(),
+                           smaller.data(), smaller.size(), scratch);
+        strip_leading_zeroes(product.limbs);
     }
-    strip_leading_zeroes(product.value);
 
     if (this->sign == num.sign)
         product.sign = '+';
@@ -1307,136 +4828,86 @@ BigInt BigInt::operator*(const BigInt& num) const {
 
 
 /*
-    divide
-    ------
-    Helper function that returns the quotient and remainder on dividing the
-    dividend by the divisor, when the divisor is 1 to 10 times the dividend.
+    BigInt::square
+    --------------
+    Returns the square of a BigInt. It is the same as multiplying the BigInt
+    by itself, which the multiplication detects and takes a squaring path for.
 */
 
-std::tuple<BigInt, BigInt> divide(const BigInt& dividend, const BigInt& divisor) {
-    BigInt quotient, remainder, temp;
-
-    temp = divisor;
-    quotient = 1;
-    while (temp < dividend) {
-        quotient++;
-        temp += divisor;
-    }
-    if (temp > dividend) {
-        quotient--;
-        remainder = dividend - (temp - divisor);
-    }
-
-    return std::make_tuple(quotient, remainder);
+BigInt BigInt::square() const {
+    return *this * *this;
 }
 
 
 /*
-    BigInt / BigInt
-    ---------------
-    Computes the quotient of two BigInts using the long-division method.
-    The operand on the RHS of the division (the divisor) is `num`.
+    divmod
+    ------
+    Returns the quotient and the remainder on dividing `dividend` by `divisor`
+    with a single long division. As with the `/` and `%` operators, the
+    quotient is truncated towards zero and the remainder takes the sign of the
+    dividend.
 */
 
-BigInt BigInt::operator/(const BigInt& num) const {
-    BigInt abs_dividend = abs(*this);
-    BigInt abs_divisor = abs(num);
-
-    if (num == 0)
+std::tuple<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor) {
+    if (divisor.limbs.empty())
         throw std::logic_error("Attempted division by zero");
-    if (abs_dividend < abs_divisor)
-        return BigInt(0);
-    if (num == 1)
-        return *this;
-    if (num == -1)
-        return -(*this);
 
-    BigInt quotient;
-    if (abs_dividend <= LLONG_MAX and abs_divisor <= LLONG_MAX)
-        quotient = std::stoll(abs_dividend.value) / std::stoll(abs_divisor.value);
-    else if (abs_dividend == abs_divisor)
-        quotient = 1;
-    else if (is_power_of_10(abs_divisor.value)) { // if divisor is a power of 10 do optimised calculation
-        size_t digits_in_quotient = abs_dividend.value.size() - abs_divisor.value.size() + 1;
-        quotient.value = abs_dividend.value.substr(0, digits_in_quotient);
+    size_t na = dividend.limbs.size(), nb = divisor.limbs.size();
+    BigInt quotient, remainder;
+    if (compare_limbs(dividend.limbs.data(), na, divisor.limbs.data(), nb) < 0) {
+        remainder = dividend;
+        return std::make_tuple(quotient, remainder);
+    }
+
+    if (na <= 2) {      // both operands fit in a double limb
+        big_double_limb a = dividend.limbs[0], b = divisor.limbs[0];
+        if (na == 2)
+            a |= (big_double_limb) dividend.limbs[1] << 64;
+        if (nb == 2)
+            b |= (big_double_limb) divisor.limbs[1] << 64;
+        assign_double_limb(quotient.limbs, a / b);
+        assign_double_limb(remainder.limbs, a % b);
     }
     else {
-        quotient.value = "";    // the value is cleared as digits will be appended
-        BigInt chunk, chunk_quotient, chunk_remainder;
-        size_t chunk_index = 0;
-        chunk_remainder.value = abs_dividend.value.substr(chunk_index, abs_divisor.value.size() - 1);
-        chunk_index = abs_divisor.value.size() - 1;
-        while (chunk_index < abs_dividend.value.size()) {
-            chunk.value = chunk_remainder.value.append(1, abs_dividend.value[chunk_index]);
-            chunk_index++;
-            while (chunk < abs_divisor) {
-                quotient.value += "0";
-                if (chunk_index < abs_dividend.value.size()) {
-                    chunk.value.append(1, abs_dividend.value[chunk_index]);
-                    chunk_index++;
-                }
-                else
-                    break;
-            }
-            if (chunk == abs_divisor) {
-                quotient.value += "1";
-                chunk_remainder = 0;
-            }
-            else if (chunk > abs_divisor) {
-                strip_leading_zeroes(chunk.value);
-                std::tie(chunk_quotient, chunk_remainder) = divide(chunk, abs_divisor);
-                quotient.value += chunk_quotient.value;
-            }
-        }
+        quotient.limbs.resize(na - nb + 1);
+        remainder.limbs.resize(nb);
+        divrem_limbs(quotient.limbs.data(), remainder.limbs.data(),
+                     dividend.limbs.data(), na, divisor.limbs.data(), nb);
+        strip_leading_zeroes(quotient.limbs);
+        strip_leading_zeroes(remainder.limbs);
     }
-    strip_leading_zeroes(quotient.value);
 
-    if (this->sign == num.sign)
-        quotient.sign = '+';
-    else
+    if (dividend.sign != divisor.sign and !quotient.limbs.empty())
         quotient.sign = '-';
+    // remainder has the same sign as that of the dividend, except if it's zero
+    if (dividend.sign == '-' and !remainder.limbs.empty())
+        remainder.sign = '-';
 
-    return quotient;
+    return std::make_tuple(quotient, remainder);
 }
 
 
 /*
-    BigInt % BigInt
+    BigInt / BigInt
     ---------------
-    Computes the modulo (remainder on division) of two BigInts.
-    The operand on the RHS of the modulo (the divisor) is `num`.
+    Computes the quotient of two BigInts using the long-division method.
+    The operand on the RHS of the division (the divisor) is `num`.
 */
 
-BigInt BigInt::operator%(const BigInt& num) const {
-    BigInt abs_dividend = abs(*this);
-    BigInt abs_divisor = abs(num);
-
-    if (abs_divisor == 0)
-        throw std::logic_error("Attempted division by zero");
-    if (abs_divisor == 1 or abs_divisor == abs_dividend)
-        return BigInt(0);
+BigInt BigInt::operator/(const BigInt& num) const {
+    return std::get<0>(divmod(*this, num));
+}
 
-    BigInt remainder;
-    if (abs_dividend <= LLONG_MAX and abs_divisor <= LLONG_MAX)
-        remainder = std::stoll(abs_dividend.value) % std::stoll(abs_divisor.value);
-    else if (abs_dividend < abs_divisor)
-        remainder = abs_dividend;
-    else if (is_power_of_10(num.value)){ // if num is a power of 10 use optimised calculation
-        size_t no_of_zeroes = num.value.size() - 1;
-        remainder.value = abs_dividend.value.substr(abs_dividend.value.size() - no_of_zeroes);
-    } 
-    else {
-        BigInt quotient = abs_dividend / abs_divisor;
-        remainder = abs_dividend - quotient * abs_divisor;
-    }
-    strip_leading_zeroes(remainder.value);
 
-    // remainder has the same sign as that of the dividend
-    remainder.sign = this->sign;
-    if (remainder.value == "0")     // except if its zero
-        remainder.sign = '+';
+/*
+    BigInt % BigInt
+    ---------------
+    Computes the modulo (remainder on division) of two BigInts.
+    The operand on the RHS of the modulo (the divisor) is `num`.
+*/
 
-    return remainder;
+BigInt BigInt::operator%(const BigInt& num) const {
+    return std::get<1>(divmod(*this, num));
 }
 
 
@@ -1445,8 +4916,11 @@ BigInt BigInt::operator%(const BigInt& num) const {
     ----------------
 */
 
-BigInt BigInt::operator+(const long long& num) const {
-    return *this + BigInt(num);
+BigInt BigInt::operator+(const long long& num) const& {
+    BigInt result;
+    add_word(result, *this, word_magnitude(num), num < 0 ? '-' : '+');
+
+    return result;
 }
 
 
@@ -1456,7 +4930,7 @@ BigInt BigInt::operator+(const long long& num) const {
 */
 
 BigInt operator+(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) + rhs;
+    return rhs + lhs;
 }
 
 
@@ -1465,8 +4939,11 @@ BigInt operator+(const long long& lhs, const BigInt& rhs) {
     ----------------
 */
 
-BigInt BigInt::operator-(const long long& num) const {
-    return *this - BigInt(num);
+BigInt BigInt::operator-(const long long& num) const& {
+    BigInt result;
+    add_word(result, *this, word_magnitude(num), num < 0 ? '+' : '-');
+
+    return result;
 }
 
 
@@ -1476,7 +4953,10 @@ BigInt BigInt::operator-(const long long& num) const {
 */
 
 BigInt operator-(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) - rhs;
+    BigInt result = -rhs;
+    result += lhs;
+
+    return result;
 }
 
 
@@ -1485,8 +4965,11 @@ BigInt operator-(const long long& lhs, const BigInt& rhs) {
     ----------------
 */
 
-BigInt BigInt::operator*(const long long& num) const {
-    return *this * BigInt(num);
+BigInt BigInt::operator*(const long long& num) const& {
+    BigInt result;
+    mul_word(result, *this, word_magnitude(num), num < 0 ? '-' : '+');
+
+    return result;
 }
 
 
@@ -1496,7 +4979,7 @@ BigInt BigInt::operator*(const long long& num) const {
 */
 
 BigInt operator*(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) * rhs;
+    return rhs * lhs;
 }
 
 
@@ -1506,7 +4989,15 @@ BigInt operator*(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator/(const long long& num) const {
-    return *this / BigInt(num);
+    if (num == 0)
+        throw std::logic_error("Attempted division by zero");
+
+    BigInt quotient;
+    divmod_word(quotient, *this, word_magnitude(num));
+    if (num < 0 and !quotient.limbs.empty())
+        quotient.sign = quotient.sign == '+' ? '-' : '+';
+
+    return quotient;
 }
 
 
@@ -1526,7 +5017,13 @@ BigInt operator/(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator%(const long long& num) const {
-    return *this % BigInt(num);
+    if (num == 0)
+        throw std::logic_error("Attempted division by zero");
+
+    // the remainder is below |num|, so it fits in a long long
+    long long remainder = mod_word(*this, word_magnitude(num));
+
+    return sign == '-' ? -remainder : remainder;
 }
 
 
@@ -1545,7 +5042,7 @@ BigInt operator%(const long long& lhs, const BigInt& rhs) {
     ---------------
 */
 
-BigInt BigInt::operator+(const std::string& num) const {
+BigInt BigInt::operator+(const std::string& num) const& {
     return *this + BigInt(num);
 }
 
@@ -1565,7 +5062,7 @@ BigInt operator+(const std::string& lhs, const BigInt& rhs) {
     ---------------
 */
 
-BigInt BigInt::operator-(const std::string& num) const {
+BigInt BigInt::operator-(const std::string& num) const& {
     return *this - BigInt(num);
 }
 
@@ -1585,7 +5082,7 @@ BigInt operator-(const std::string& lhs, const BigInt& rhs) {
     ---------------
 */
 
-BigInt BigInt::operator*(const std::string& num) const {
+BigInt BigInt::operator*(const std::string& num) const& {
     return *this * BigInt(num);
 }
 
@@ -1639,6 +5136,71 @@ BigInt operator%(const std::string& lhs, const BigInt& rhs) {
     return BigInt(lhs) % rhs;
 }
 
+
+/*
+    Temporary BigInt + - * BigInt, Integer or String
+    -------------------------------------------------
+    When the LHS is a temporary, such as the result of another operator, it is
+    updated with the matching arithmetic-assignment operator and moved out as
+    the result. Sums, differences and products by a single limb are then
+    computed in place in its limbs, so chained expressions like `(a + b) - c`
+    or `a * i * j` do not allocate a new buffer at each step.
+*/
+
+BigInt BigInt::operator+(const BigInt& num) && {
+    *this += num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator+(const long long& num) && {
+    *this += num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator+(const std::string& num) && {
+    *this += num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator-(const BigInt& num) && {
+    *this -= num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator-(const long long& num) && {
+    *this -= num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator-(const std::string& num) && {
+    *this -= num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator*(const BigInt& num) && {
+    *this *= num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator*(const long long& num) && {
+    *this *= num;
+
+    return std::move(*this);
+}
+
+BigInt BigInt::operator*(const std::string& num) && {
+    *this *= num;
+
+    return std::move(*this);
+}
+
 #endif  // BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
 
 
@@ -1659,7 +5221,7 @@ BigInt operator%(const std::string& lhs, const BigInt& rhs) {
 */
 
 BigInt& BigInt::operator+=(const BigInt& num) {
-    *this = *this + num;
+    add_signed(*this, *this, num, num.sign);
 
     return *this;
 }
@@ -1671,7 +5233,7 @@ BigInt& BigInt::operator+=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator-=(const BigInt& num) {
-    *this = *this - num;
+    add_signed(*this, *this, num, num.sign == '+' ? '-' : '+');
 
     return *this;
 }
@@ -1683,7 +5245,51 @@ BigInt& BigInt::operator-=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator*=(const BigInt& num) {
-    *this = *this * num;
+    if (num.limbs.size() == 1 and !limbs.empty()) {
+        // a single-limb multiplier scales the limbs in place
+        big_limb carry = mul_limb(limbs.data(), limbs.data(), limbs.size(), num.limbs[0]);
+        if (carry)
+            limbs.push_back(carry);
+        if (num.sign == '-')
+            sign = sign == '+' ? '-' : '+';
+    }
+    else
+        *this = *this * num;
+
+    return *this;
+}
+
+
+/*
+    BigInt::add_product / BigInt::sub_product
+    -----------------------------------------
+    Fused multiply-add and multiply-subtract: `x.add_product(a, b)` computes
+    x += a * b, and `x.sub_product(a, b)` computes x -= a * b, without
+    building the product as a BigInt of its own. The second factor can also
+    be an integer (up to `long long`), which works on the limbs of `x`
+    directly.
+*/
+
+BigInt& BigInt::add_product(const BigInt& lhs, const BigInt& rhs) {
+    add_product_signed(*this, lhs, rhs, lhs.sign == rhs.sign ? '+' : '-');
+
+    return *this;
+}
+
+BigInt& BigInt::sub_product(const BigInt& lhs, const BigInt& rhs) {
+    add_product_signed(*this, lhs, rhs, lhs.sign == rhs.sign ? '-' : '+');
+
+    return *this;
+}
+
+BigInt& BigInt::add_product(const BigInt& lhs, const long long& rhs) {
+    add_product_word(*this, lhs, word_magnitude(rhs), lhs.sign == (rhs < 0 ? '-' : '+') ? '+' : '-');
+
+    return *this;
+}
+
+BigInt& BigInt::sub_product(const BigInt& lhs, const long long& rhs) {
+    add_product_word(*this, lhs, word_magnitude(rhs), lhs.sign == (rhs < 0 ? '-' : '+') ? '-' : '+');
 
     return *this;
 }
@@ -1719,7 +5325,7 @@ BigInt& BigInt::operator%=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator+=(const long long& num) {
-    *this = *this + BigInt(num);
+    add_word(*this, *this, word_magnitude(num), num < 0 ? '-' : '+');
 
     return *this;
 }
@@ -1731,7 +5337,7 @@ BigInt& BigInt::operator+=(const long long& num) {
 */
 
 BigInt& BigInt::operator-=(const long long& num) {
-    *this = *this - BigInt(num);
+    add_word(*this, *this, word_magnitude(num), num < 0 ? '+' : '-');
 
     return *this;
 }
@@ -1743,7 +5349,7 @@ BigInt& BigInt::operator-=(const long long& num) {
 */
 
 BigInt& BigInt::operator*=(const long long& num) {
-    *this = *this * BigInt(num);
+    mul_word(*this, *this, word_magnitude(num), num < 0 ? '-' : '+');
 
     return *this;
 }
@@ -1755,7 +5361,12 @@ BigInt& BigInt::operator*=(const long long& num) {
 */
 
 BigInt& BigInt::operator/=(const long long& num) {
-    *this = *this / BigInt(num);
+    if (num == 0)
+        throw std::logic_error("Attempted division by zero");
+
+    divmod_word(*this, *this, word_magnitude(num));
+    if (num < 0 and !limbs.empty())
+        sign = sign == '+' ? '-' : '+';
 
     return *this;
 }
@@ -1767,7 +5378,7 @@ BigInt& BigInt::operator/=(const long long& num) {
 */
 
 BigInt& BigInt::operator%=(const long long& num) {
-    *this = *this % BigInt(num);
+    *this = *this % num;
 
     return *this;
 }
@@ -1853,7 +5464,14 @@ BigInt& BigInt::operator%=(const std::string& num) {
 */
 
 BigInt& BigInt::operator++() {
-    *this += 1;
+    if (sign == '-') {
+        decrement_limbs(limbs.data(), limbs.size());
+        strip_leading_zeroes(limbs);
+        if (limbs.empty())
+            sign = '+';
+    }
+    else if (increment_limbs(limbs.data(), limbs.size()))
+        limbs.push_back(1);
 
     return *this;
 }
@@ -1866,7 +5484,15 @@ BigInt& BigInt::operator++() {
 */
 
 BigInt& BigInt::operator--() {
-    *this -= 1;
+    if (sign == '+' and !limbs.empty()) {
+        decrement_limbs(limbs.data(), limbs.size());
+        strip_leading_zeroes(limbs);
+    }
+    else {
+        if (increment_limbs(limbs.data(), limbs.size()))
+            limbs.push_back(1);
+        sign = '-';
+    }
 
     return *this;
 }
@@ -1880,7 +5506,7 @@ BigInt& BigInt::operator--() {
 
 BigInt BigInt::operator++(int) {
     BigInt temp = *this;
-    *this += 1;
+    ++*this;
 
     return temp;
 }
@@ -1894,7 +5520,7 @@ BigInt BigInt::operator++(int) {
 
 BigInt BigInt::operator--(int) {
     BigInt temp = *this;
-    *this -= 1;
+    --*this;
 
     return temp;
 }
@@ -1902,6 +5528,294 @@ BigInt BigInt::operator--(int) {
 #endif  // BIG_INT_INCREMENT_DECREMENT_OPERATORS_HPP
 
 
+/*
+    ===========================================================================
+    Bitwise operators
+    ===========================================================================
+    The bitwise operators treat a BigInt as an infinite string of bits in
+    two's complement, as Python does: `~x` is -x - 1, `&`, `|` and `^` extend
+    the sign of the shorter operand, and `>>` rounds towards minus infinity.
+    The shifts move whole limbs and then the remaining bits in a single pass.
+*/
+
+#ifndef BIG_INT_BITWISE_OPERATORS_HPP
+#define BIG_INT_BITWISE_OPERATORS_HPP
+
+#include <algorithm>
+#include <bit>
+
+
+/*
+    bitwise_signed
+    --------------
+    Computes result = lhs `op` rhs, where `op` is '&', '|' or '^', in a single
+    pass. The negative operands are converted to two's complement limb by
+    limb as they are read, with one more limb than the longer operand for the
+    sign, and a negative result is converted back into a magnitude at the
+    end. `result` may be the same object as either operand.
+*/
+
+void bitwise_signed(BigInt& result, const BigInt& lhs, const BigInt& rhs, char op) {
+    auto apply = [op](big_limb a, big_limb b) {
+        return op == '&' ? a & b : op == '|' ? a | b : a ^ b;
+    };
+
+    size_t lhs_size = lhs.limbs.size(), rhs_size = rhs.limbs.size();
+    size_t size = std::max(lhs_size, rhs_size) + 1;
+    big_limb lhs_borrow = lhs.sign == '-', rhs_borrow = rhs.sign == '-';
+    bool negative = apply(-lhs_borrow, -rhs_borrow) != 0;
+
+    // the buffer may belong to an operand, so take the pointers after
+    // resizing; each limb is read before the one at its index is written
+    result.limbs.resize(size);
+    big_limb* r = result.limbs.data();
+    const big_limb* a = lhs.limbs.data();
+    const big_limb* b = rhs.limbs.data();
+    for (size_t i = 0; i < size; i++) {
+        // ~(m - 1) is the two's complement of a magnitude m
+        big_limb x = i < lhs_size ? a[i] : 0;
+        big_limb y = i < rhs_size ? b[i] : 0;
+        if (lhs.sign == '-') {
+            big_limb limb = x;
+            x = ~(limb - lhs_borrow);
+            lhs_borrow = limb < lhs_borrow;
+        }
+        if (rhs.sign == '-') {
+            big_limb limb = y;
+            y = ~(limb - rhs_borrow);
+            rhs_borrow = limb < rhs_borrow;
+        }
+        r[i] = apply(x, y);
+    }
+
+    if (negative)
+        negate_limbs(r, size);
+    strip_leading_zeroes(result.limbs);
+    result.sign = negative ? '-' : '+';
+}
+
+
+/*
+    lshift_signed
+    -------------
+    Computes result = num * 2^shift. The limbs are moved up by whole limbs
+    and then shifted by the remaining bits in place. `result` may be the same
+    object as `num`.
+*/
+
+void lshift_signed(BigInt& result, const BigInt& num, size_t shift) {
+    size_t size = num.limbs.size(), words = shift / 64;
+    unsigned bits = shift % 64;
+    char sign = num.sign;
+    if (size == 0) {
+        result.limbs.clear();
+        result.sign = '+';
+        return;
+    }
+
+    // only grow by a limb when bits actually spill out of the top one
+    big_limb carry = bits ? num.limbs[size - 1] >> (64 - bits) : 0;
+
+    // the buffer may belong to `num`, so take the pointers after resizing
+    result.limbs.resize(size + words + (carry != 0));
+    big_limb* r = result.limbs.data();
+    const big_limb* a = num.limbs.data();
+    std::copy_backward(a, a + size, r + size + words);
+    std::fill(r, r + words, 0);
+    if (bits)
+        lshift_limbs(r + words, r + words, size, bits);
+    if (carry)
+        r[size + words] = carry;
+
+    strip_leading_zeroes(result.limbs);
+    result.sign = sign;
+}
+
+
+/*
+    rshift_signed
+    -------------
+    Computes result = floor(num / 2^shift). The limbs are moved down by whole
+    limbs and then shifted by the remaining bits in place. A negative number
+    that loses any set bit is rounded down by adding one to its magnitude.
+    `result` may be the same object as `num`.
+*/
+
+void rshift_signed(BigInt& result, const BigInt& num, size_t shift) {
+    size_t size = num.limbs.size(), words = std::min(shift / 64, size);
+    unsigned bits = shift % 64;
+    char sign = num.sign;
+    const big_limb* a = num.limbs.data();
+    bool inexact = sign == '-' and
+        (std::any_of(a, a + words, [](big_limb limb) { return limb != 0; })
+         or (words < size and bits and (a[words] << (64 - bits)) != 0));
+
+    // moving the limbs down within the buffer of `num` itself is safe
+    if (&result != &num)
+        result.limbs.resize(size - words);
+    big_limb* r = result.limbs.data();
+    std::copy(a + words, a + size, r);
+    result.limbs.resize(size - words);
+    if (bits and words < size)
+        rshift_limbs(r, r, size - words, bits);
+
+    strip_leading_zeroes(result.limbs);
+    result.sign = result.limbs.empty() ? '+' : sign;
+    if (inexact)
+        add_word(result, result, 1, '-');
+}
+
+
+/*
+    ~BigInt
+    -------
+*/
+
+BigInt BigInt::operator~() const {
+    BigInt result = -*this;
+    add_word(result, result, 1, '-');
+
+    return result;
+}
+
+
+/*
+    BigInt & BigInt, BigInt | BigInt, BigInt ^ BigInt
+    -------------------------------------------------
+*/
+
+BigInt BigInt::operator&(const BigInt& num) const {
+    BigInt result;
+    bitwise_signed(result, *this, num, '&');
+
+    return result;
+}
+
+BigInt BigInt::operator|(const BigInt& num) const {
+    BigInt result;
+    bitwise_signed(result, *this, num, '|');
+
+    return result;
+}
+
+BigInt BigInt::operator^(const BigInt& num) const {
+    BigInt result;
+    bitwise_signed(result, *this, num, '^');
+
+    return result;
+}
+
+
+/*
+    BigInt << Integer, BigInt >> Integer
+    ------------------------------------
+*/
+
+BigInt BigInt::operator<<(size_t shift) const {
+    BigInt result;
+    lshift_signed(result, *this, shift);
+
+    return result;
+}
+
+BigInt BigInt::operator>>(size_t shift) const {
+    BigInt result;
+    rshift_signed(result, *this, shift);
+
+    return result;
+}
+
+
+/*
+    BigInt &= BigInt, BigInt |= BigInt, BigInt ^= BigInt
+    ----------------------------------------------------
+*/
+
+BigInt& BigInt::operator&=(const BigInt& num) {
+    bitwise_signed(*this, *this, num, '&');
+
+    return *this;
+}
+
+BigInt& BigInt::operator|=(const BigInt& num) {
+    bitwise_signed(*this, *this, num, '|');
+
+    return *this;
+}
+
+BigInt& BigInt::operator^=(const BigInt& num) {
+    bitwise_signed(*this, *this, num, '^');
+
+    return *this;
+}
+
+
+/*
+    BigInt <<= Integer, BigInt >>= Integer
+    --------------------------------------
+*/
+
+BigInt& BigInt::operator<<=(size_t shift) {
+    lshift_signed(*this, *this, shift);
+
+    return *this;
+}
+
+BigInt& BigInt::operator>>=(size_t shift) {
+    rshift_signed(*this, *this, shift);
+
+    return *this;
+}
+
+
+/*
+    BigInt::bit_length
+    ------------------
+    Returns the number of bits in the absolute value, 0 for zero.
+*/
+
+size_t BigInt::bit_length() const {
+    if (limbs.empty())
+        return 0;
+
+    return 64 * (limbs.size() - 1) + std::bit_width(limbs.back());
+}
+
+
+/*
+    BigInt::popcount
+    ----------------
+    Returns the number of bits set in the absolute value.
+*/
+
+size_t BigInt::popcount() const {
+    size_t count = 0;
+    for (big_limb limb : limbs)
+        count += std::popcount(limb);
+
+    return count;
+}
+
+
+/*
+    BigInt::countr_zero
+    -------------------
+    Returns the number of zero bits below the lowest set bit, which is the
+    exponent of the largest power of two that divides the BigInt, or 0 for
+    zero.
+*/
+
+size_t BigInt::countr_zero() const {
+    for (size_t i = 0; i < limbs.size(); i++)
+        if (limbs[i] != 0)
+            return 64 * i + std::countr_zero(limbs[i]);
+
+    return 0;
+}
+
+#endif  // BIG_INT_BITWISE_OPERATORS_HPP
+
+
 /*
     ===========================================================================
     I/O stream operators
@@ -1930,16 +5844,193 @@ std::istream& operator>>(std::istream& in, BigInt& num) {
 /*
     BigInt to output stream
     -----------------------
+    Writes a BigInt as the stream writes integers: in the base set by
+    std::hex, std::oct or std::dec, with the std::showbase, std::showpos
+    and std::uppercase flags, and padded with the fill character to the width
+    of the stream, on the side set by std::left, std::right or std::internal.
+    The digits go to the stream in blocks, without building the whole text.
 */
 
 std::ostream& operator<<(std::ostream& out, const BigInt& num) {
+    std::ios_base::fmtflags flags = out.flags();
+    std::ios_base::fmtflags basefield = flags & std::ios_base::basefield;
+    std::ios_base::fmtflags adjustfield = flags & std::ios_base::adjustfield;
+    int base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+    bool uppercase = flags & std::ios_base::uppercase;
+
+    std::string prefix;
     if (num.sign == '-')
-        out << num.sign;
-    out << num.value;
+        prefix += '-';
+    else if (flags & std::ios_base::showpos)
+        prefix += '+';
+    if ((flags & std::ios_base::showbase) and not num.limbs.empty()) {
+        if (base == 16)
+            prefix += uppercase ? "0X" : "0x";
+        else if (base == 8)
+            prefix += '0';
+    }
+
+    size_t width = out.width() > 0 ? out.width() : 0;
+    size_t after = 0;
+    auto pad = [&](size_t count) {
+        for (; count > 0; count--)
+            out.put(out.fill());
+    };
+    auto start = [&](size_t count) {
+        size_t length = prefix.size() + count;
+        size_t padding = width > length ? width - length : 0;
+        if (adjustfield == std::ios_base::left)
+            after = padding;
+        else if (adjustfield == std::ios_base::internal) {
+            out.write(prefix.data(), prefix.size());
+            pad(padding);
+            return;
+        }
+        else
+            pad(padding);
+        out.write(prefix.data(), prefix.size());
+    };
+    write_digits(num, base, uppercase, start,
+                 [&](const char* digits, size_t count) { out.write(digits, count); });
+    pad(after);
+    out.width(0);
 
     return out;
 }
 
+
+/*
+    std::formatter<BigInt>
+    ----------------------
+    Formats BigInts in std::format and std::print, writing the digits to the
+    output with the padding and the separators, without building the string
+    of `to_string` first. The format spec is
+
+        [[fill]align][sign]['#']['0'][width][grouping][type]
+
+    as for the integers, where `grouping` is ',' or '_' to separate groups of
+    three decimal digits, or of four digits in the other bases, and `type` is
+    'd' (the default), 'x', 'X', 'o', 'b' or 'B'. For instance,
+    std::format("{:>20,}", big1) or std::format("{:#x}", big1).
+*/
+
+#include <version>
+
+#ifdef __cpp_lib_format
+#include <format>
+#include <string_view>
+
+template <>
+struct std::formatter<BigInt> {
+    char fill = ' ';
+    char align = 0;             // '<', '>', '^' or 0 for the default
+    char sign = '-';            // '-', '+' or ' '
+    bool alternate = false;     // '#', for the base prefix
+    bool zero_padding = false;
+    size_t width = 0;
+    char grouping = 0;          // ',', '_' or 0 for none
+    char type = 'd';
+
+    constexpr auto parse(std::format_parse_context& ctx) {
+        auto it = ctx.begin(), end = ctx.end();
+        auto is_align = [](char c) { return c == '<' or c == '>' or c == '^'; };
+
+        // an empty spec: `it` is the closing brace of the replacement field
+        if (it == end or *it == '}')
+            return it;
+
+        if (end - it >= 2 and is_align(it[1])) {
+            if (it[0] == '{' or it[0] == '}')
+                throw std::format_error("Invalid fill character for BigInt");
+            fill = it[0];
+            align = it[1];
+            it += 2;
+        }
+        else if (it != end and is_align(*it))
+            align = *it++;
+        if (it != end and (*it == '+' or *it == '-' or *it == ' '))
+            sign = *it++;
+        if (it != end and *it == '#') {
+            alternate = true;
+            ++it;
+        }
+        if (it != end and *it == '0') {
+            zero_padding = true;
+            ++it;
+        }
+        while (it != end and *it >= '0' and *it <= '9')
+            width = width * 10 + (*it++ - '0');
+        if (it != end and *it == '{')
+            throw std::format_error("Nested replacement fields are not supported for BigInt");
+        if (it != end and (*it == ',' or *it == '_'))
+            grouping = *it++;
+        if (it != end and std::string_view("dxXobB").find(*it) != std::string_view::npos)
+            type = *it++;
+        if (it != end and *it != '}')
+            throw std::format_error("Invalid format spec for BigInt");
+
+        return it;
+    }
+
+    template <typename FormatContext>
+    auto format(const BigInt& num, FormatContext& ctx) const {
+        int base = type == 'x' or type == 'X' ? 16 : type == 'o' ? 8 : type == 'b' or type == 'B' ? 2 : 10;
+
+        // the sign and the base prefix
+        std::string prefix;
+        if (num < 0)
+            prefix += '-';
+        else if (sign != '-')
+            prefix += sign;
+        if (alternate and base != 10 and not (base == 8 and num == 0))
+            prefix += base == 8 ? "0" : base == 16 ? (type == 'X' ? "0X" : "0x")
+                                                   : (type == 'B' ? "0B" : "0b");
+
+        // the digits go straight to the output, once their number gives the
+        // padding and the place of the first separator
+        size_t group = base == 10 ? 3 : 4;
+        size_t total = 0, remaining = 0, after = 0;
+        auto out = ctx.out();
+        auto start = [&](size_t count) {
+            size_t length = prefix.size() + count;
+            if (grouping)
+                length += (count - 1) / group;
+            size_t padding = width > length ? width - length : 0;
+
+            // numbers are aligned to the right by default, and '0' pads
+            // between the prefix and the digits when there is no alignment
+            size_t before = align == '<' ? 0 : align == '^' ? padding / 2 : padding;
+            if (zero_padding and not align) {
+                out = std::copy(prefix.begin(), prefix.end(), out);
+                out = std::fill_n(out, padding, '0');
+            }
+            else {
+                out = std::fill_n(out, before, fill);
+                out = std::copy(prefix.begin(), prefix.end(), out);
+                after = padding - before;
+            }
+            total = remaining = count;
+        };
+        auto write = [&](const char* digits, size_t count) {
+            if (not grouping) {
+                out = std::copy(digits, digits + count, out);
+                return;
+            }
+            for (size_t i = 0; i < count; i++, remaining--) {
+                if (remaining != total and remaining % group == 0)
+                    *out++ = grouping;
+                *out++ = digits[i];
+            }
+        };
+        write_digits(num, base, type == 'X', start, write);
+
+        out = std::fill_n(out, after, fill);
+
+        return out;
+    }
+};
+#endif  // __cpp_lib_format
+
 #endif  // BIG_INT_IO_STREAM_OPERATORS_HPP
 
 
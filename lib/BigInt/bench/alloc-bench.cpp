@@ -0,0 +1,170 @@
+// alloc-bench.cpp - Allocation benchmark for the BigInt memory resources
+//
+// Computes N! in a product tree, as calculate_factorial() of the factorial examples does, and with the running product
+// of cancellable_calculate_factorial(), first with the BigInt buffers on the global heap and then inside a monotonic
+// arena and an unsynchronized pool resource set with BigIntMemoryScope. For each run it reports the wall time, the
+// buffers that the BigInts asked for and the allocations that reached the global heap. The two calculations are
+// repeated here, without the messages of the examples, so that the benchmark needs neither <print> nor src/common.
+//
+//  Usage:
+//
+//      bigint-alloc-bench [N]
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+
+#include <BigInt/BigInt.hpp>
+
+std::atomic<size_t> heap_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    heap_allocations++;
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Memory resource that counts the requests it passes on to another one.
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    explicit counting_resource(std::pmr::memory_resource* upstream)
+        : upstream_(upstream)
+    {}
+
+    size_t allocations() const { return allocations_; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocations_++;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+    {
+        upstream_->deallocate(memory, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_ = 0;
+};
+
+// Computes N! in a balanced product tree
+BigInt product_tree_factorial(const BigInt& number)
+{
+    return big_range_product( 2, number );
+}
+
+// Computes N! multiplying a running product by each factor
+BigInt running_product_factorial(const BigInt& number)
+{
+    BigInt factorial = 1;
+    for ( BigInt i = 2; i <= number; i++ )
+    {
+        factorial *= i;
+    }
+    return factorial;
+}
+
+enum class memory_mode { heap, arena, pool };
+
+template <typename Function>
+void run(const std::string& label, memory_mode mode, Function calculation)
+{
+    // 'upstream' sees what the arena or the pool take from the heap, and 'requests' what the BigInts ask them for
+    counting_resource upstream( std::pmr::new_delete_resource() );
+    size_t heap_before = heap_allocations;
+    size_t buffer_requests = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (mode == memory_mode::heap)
+    {
+        calculation();
+    }
+    else if (mode == memory_mode::arena)
+    {
+        std::pmr::monotonic_buffer_resource arena( 1 << 20, &upstream );
+        counting_resource requests( &arena );
+        BigIntMemoryScope scope( &requests );
+        calculation();
+        buffer_requests = requests.allocations();
+    }
+    else
+    {
+        std::pmr::unsynchronized_pool_resource pool( &upstream );
+        counting_resource requests( &pool );
+        BigIntMemoryScope scope( &requests );
+        calculation();
+        buffer_requests = requests.allocations();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    size_t heap = heap_allocations - heap_before + upstream.allocations();
+    std::cout << std::left << std::setw(36) << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1)
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << std::setw(14) << (mode == memory_mode::heap ? "-" : std::to_string(buffer_requests))
+              << std::setw(16) << heap << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    BigInt number = argc > 1 ? BigInt(argv[1]) : BigInt(50000);
+
+    // Only the BigInt memory, and not the threads, is under test here
+    big_int_thresholds.mul_threads = 1;
+
+    // A first run warms up the per-thread caches of the library
+    product_tree_factorial( number );
+
+    struct { std::string name; memory_mode mode; } modes[] = {
+        { "global heap", memory_mode::heap },
+        { "monotonic arena", memory_mode::arena },
+        { "unsynchronized pool", memory_mode::pool },
+    };
+
+    std::cout << "\n" << std::left << std::setw(36) << ("N = " + number.to_string()) << std::right
+              << std::setw(13) << "time" << std::setw(14) << "requests" << std::setw(16) << "heap allocs" << "\n";
+
+    for (const auto& mode : modes)
+    {
+        run( "product tree, " + mode.name, mode.mode, [&] {
+            product_tree_factorial( number );
+        });
+    }
+
+    for (const auto& mode : modes)
+    {
+        run( "running product, " + mode.name, mode.mode, [&] {
+            running_product_factorial( number );
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+// bench.cpp - Microbenchmarks for the BigInt operations
+//
+// Times the arithmetic operators, pow, sqrt, gcd and the conversions to and from decimal strings for operands from
+// 10 to 10^6 decimal digits. For each operation and size it reports the time per operation, the allocations per
+// operation that reached the global heap and the throughput in operand digits per second, either as CSV or as JSON,
+// so that the results of different versions of the library can be compared.
+//
+// The operands are built from a fixed seed, so every run works on the same numbers. The divisions take a dividend
+// with twice the digits of the divisor, sqrt takes a radicand with twice the digits of the root and pow raises a
+// 10-digit base to the power that gives a result of the given size. gcd is quadratic and stops at 10^5 digits.
+//
+//  Usage:
+//
+//      bigint-bench [--format csv|json] [--max-digits D] [--min-time MS] [OPERATION...]
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <BigInt/BigInt.hpp>
+
+std::atomic<size_t> heap_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    heap_allocations++;
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Where the results go, so that the compiler cannot drop the operations
+BigInt sink;
+size_t sink_size = 0;
+
+struct operands
+{
+    BigInt a, b;
+    BigInt wide;            // twice the digits, for / % and sqrt
+    BigInt base;            // 10 digits, for pow
+    int exponent;
+    std::string digits;
+};
+
+struct operation
+{
+    std::string name;
+    size_t max_digits;
+    std::function<void(operands&)> body;
+};
+
+struct measurement
+{
+    std::string operation;
+    size_t digits;
+    size_t iterations;
+    double ns_per_op;
+    double allocations_per_op;
+    double digits_per_second;
+};
+
+// Runs the operation in batches that double in length until one of them lasts at least 'min_time', and reports the
+// last batch, so that the clock is read a few times and not once per operation.
+measurement measure(const operation& op, operands& args, size_t num_digits, std::chrono::nanoseconds min_time)
+{
+    // A first run warms up the caches and the per-thread scratch buffers of the library
+    op.body( args );
+
+    for (size_t iterations = 1;; iterations *= 2)
+    {
+        size_t heap_before = heap_allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            op.body( args );
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        size_t heap = heap_allocations - heap_before;
+
+        if (elapsed >= min_time)
+        {
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+            return {
+                op.name, num_digits, iterations, ns,
+                static_cast<double>(heap) / iterations,
+                num_digits * 1e9 / ns
+            };
+        }
+    }
+}
+
+void print_csv(const std::vector<measurement>& results)
+{
+    std::cout << "operation,digits,iterations,ns_per_op,allocations_per_op,digits_per_second\n";
+    for (const auto& result : results)
+    {
+        std::cout << result.operation << ',' << result.digits << ',' << result.iterations << ','
+                  << result.ns_per_op << ',' << result.allocations_per_op << ','
+                  << result.digits_per_second << '\n';
+    }
+}
+
+void print_json(const std::vector<measurement>& results)
+{
+    std::cout << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        std::cout << (i ? "," : "") << "\n    { \"operation\": \"" << result.operation << "\""
+                  << ", \"digits\": " << result.digits
+                  << ", \"iterations\": " << result.iterations
+                  << ", \"ns_per_op\": " << result.ns_per_op
+                  << ", \"allocations_per_op\": " << result.allocations_per_op
+                  << ", \"digits_per_second\": " << result.digits_per_second << " }";
+    }
+    std::cout << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+    bool json = false;
+    size_t max_digits = 1000000;
+    std::chrono::milliseconds min_time( 200 );
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp( argv[i], "--format" ) == 0 && has_value)
+        {
+            std::string format = argv[++i];
+            if (format != "csv" && format != "json")
+            {
+                std::cerr << "bigint-bench: unknown format '" << format << "'\n";
+                return EXIT_FAILURE;
+            }
+            json = format == "json";
+        }
+        else if (std::strcmp( argv[i], "--max-digits" ) == 0 && has_value)
+        {
+            max_digits = std::stoul( argv[++i] );
+        }
+        else if (std::strcmp( argv[i], "--min-time" ) == 0 && has_value)
+        {
+            min_time = std::chrono::milliseconds( std::stoul( argv[++i] ) );
+        }
+        else if (argv[i][0] == '-')
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--format csv|json] [--max-digits D] [--min-time MS] [OPERATION...]\n";
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            selected.push_back( argv[i] );
+        }
+    }
+
+    std::vector<operation> operations = {
+        { "add", SIZE_MAX, [](operands& x) { sink = x.a + x.b; } },
+        { "sub", SIZE_MAX, [](operands& x) { sink = x.a - x.b; } },
+        { "mul", SIZE_MAX, [](operands& x) { sink = x.a * x.b; } },
+        { "div", SIZE_MAX, [](operands& x) { sink = x.wide / x.b; } },
+        { "mod", SIZE_MAX, [](operands& x) { sink = x.wide % x.b; } },
+        { "pow", SIZE_MAX, [](operands& x) { sink = pow( x.base, x.exponent ); } },
+        { "sqrt", SIZE_MAX, [](operands& x) { sink = sqrt( x.wide ); } },
+        { "gcd", 100000, [](operands& x) { sink = gcd( x.a, x.b ); } },
+        { "to_string", SIZE_MAX, [](operands& x) { sink_size += x.a.to_string().size(); } },
+        { "from_string", SIZE_MAX, [](operands& x) { sink = BigInt( x.digits ); } },
+    };
+
+    std::erase_if( operations, [&](const operation& op) {
+        return !selected.empty() && std::find( selected.begin(), selected.end(), op.name ) == selected.end();
+    });
+
+    std::mt19937_64 engine( 20240601 );
+    std::vector<measurement> results;
+
+    for (size_t num_digits = 10; num_digits <= max_digits; num_digits *= 10)
+    {
+        operands args;
+        args.a = big_random( num_digits, engine );
+        args.b = big_random( num_digits, engine );
+        args.wide = big_random( 2 * num_digits, engine );
+        args.base = big_random( 10, engine );
+        args.digits = args.a.to_string();
+        args.exponent = static_cast<int>(num_digits / 10);
+
+        for (const auto& op : operations)
+        {
+            if (num_digits <= op.max_digits)
+            {
+                results.push_back( measure( op, args, num_digits, min_time ) );
+                std::cerr << op.name << ", " << num_digits << " digits\n";
+            }
+        }
+    }
+
+    if (json)
+    {
+        print_json( results );
+    }
+    else
+    {
+        print_csv( results );
+    }
+
+    return EXIT_SUCCESS;
+}
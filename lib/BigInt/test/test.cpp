@@ -0,0 +1,1203 @@
+// test.cpp - Behaviour and regression tests for the BigInt library
+//
+// The engines are checked against simpler ones or against identities, on operands drawn from a fixed seed, and some
+// tests keep a case that once gave a wrong result. A failed check prints the expression, the file and the line, and
+// the program exits with a non-zero status once all of the tests have run.
+//
+//  Usage:
+//
+//      bigint-test
+//
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <BigInt/BigInt.hpp>
+
+int failures = 0;
+
+#define CHECK(condition)                                                                            \
+    do                                                                                              \
+    {                                                                                               \
+        if (!(condition))                                                                           \
+        {                                                                                           \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " #condition "\n";         \
+            failures++;                                                                             \
+        }                                                                                           \
+    } while (false)
+
+// Restores the thresholds that a test changed
+struct saved_thresholds
+{
+    BigIntThresholds saved = big_int_thresholds;
+
+    ~saved_thresholds()
+    {
+        big_int_thresholds = saved;
+    }
+};
+
+std::mt19937_64 engine( 20240601 );
+
+// Magnitudes are kept in 64-bit limbs, so the values around the limb boundaries convert both ways
+void test_limb_storage()
+{
+    CHECK( BigInt( "18446744073709551615" ) + 1 == BigInt( "18446744073709551616" ) );
+    CHECK( BigInt( "340282366920938463463374607431768211456" ) == pow( BigInt( 2 ), 128 ) );
+    CHECK( pow( BigInt( -2 ), 127 ).to_string() == "-170141183460469231731687303715884105728" );
+    CHECK( BigInt( "-0" ).to_string() == "0" );
+    CHECK( BigInt( LLONG_MIN ).to_long_long() == LLONG_MIN );
+    CHECK( BigInt( "-9223372036854775808" ).to_long_long() == LLONG_MIN );
+
+    bool thrown = false;
+    try
+    {
+        BigInt( "9223372036854775808" ).to_long_long();
+    }
+    catch (const std::out_of_range&)
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+}
+
+// Additions and subtractions carry and borrow across every limb, and work in place when an operand is the result
+void test_addition_and_subtraction()
+{
+    for (int limbs = 1; limbs <= 40; limbs += 13)
+    {
+        BigInt power = pow( BigInt( 2 ), 64 * limbs );
+        CHECK( (power - 1) + 1 == power );
+        CHECK( power - 1 - power == -1 );
+        CHECK( -power + (power - 1) == -1 );
+        CHECK( 1 - power == -(power - 1) );
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        BigInt a = big_random_bits( engine() % 3000, engine ) - big_random_bits( engine() % 3000, engine );
+        BigInt b = big_random_bits( engine() % 3000, engine ) - big_random_bits( engine() % 3000, engine );
+        BigInt sum = a + b;
+        CHECK( sum - b == a );
+        CHECK( sum - a == b );
+        CHECK( a - a == 0 );
+        CHECK( (a - a).to_string() == "0" );
+
+        BigInt c = a;
+        c += c;
+        CHECK( c == a * 2 );
+        c -= c;
+        CHECK( c == 0 );
+        c = a;
+        c -= b;
+        CHECK( c + b == a );
+    }
+}
+
+// Karatsuba and Toom-3 give the products of long multiplication, down to the smallest cutoffs
+void test_multiplication_engines()
+{
+    saved_thresholds saved;
+    for (int i = 0; i < 40; ++i)
+    {
+        BigInt a = big_random_bits( engine() % 4000, engine );
+        BigInt b = big_random_bits( engine() % 4000, engine );
+        if (i % 2)
+        {
+            a = -a;
+        }
+
+        big_int_thresholds.karatsuba = big_int_thresholds.toom3 = big_int_thresholds.ntt = SIZE_MAX;
+        BigInt product = a * b, square = a * a;
+        for (size_t karatsuba : { 0, 1, 2, 5 })
+        {
+            for (size_t toom3 : { 3, 9, 1000 })
+            {
+                big_int_thresholds.karatsuba = karatsuba;
+                big_int_thresholds.toom3 = toom3;
+                CHECK( a * b == product );
+                CHECK( a * a == square );
+            }
+        }
+    }
+
+    // a cutoff of 0 or 1 once split one-limb operands forever
+    big_int_thresholds.karatsuba = 1;
+    BigInt a = pow( BigInt( 10 ), 400 ) - 1, b = pow( BigInt( 10 ), 50 ) - 1;
+    CHECK( a * b == pow( BigInt( 10 ), 450 ) - pow( BigInt( 10 ), 400 ) - pow( BigInt( 10 ), 50 ) + 1 );
+}
+
+// The three-prime NTT gives the products of long multiplication, both at small cutoffs and at its default one
+void test_ntt_multiplication()
+{
+    saved_thresholds saved;
+    for (int i = 0; i < 20; ++i)
+    {
+        BigInt a = big_random_bits( engine() % 5000, engine ) - big_random_bits( 100, engine );
+        BigInt b = big_random_bits( engine() % 5000, engine );
+
+        big_int_thresholds.karatsuba = big_int_thresholds.toom3 = big_int_thresholds.ntt = SIZE_MAX;
+        BigInt product = a * b, square = a * a;
+        for (size_t ntt : { 1, 2, 7, 30 })
+        {
+            big_int_thresholds.ntt = ntt;
+            CHECK( a * b == product );
+            CHECK( a * a == square );
+        }
+    }
+
+    // operands above the default cutoff, checked modulo a prime of about 64 bits
+    big_int_thresholds = saved.saved;
+    BigInt a = big_random_bits( 64 * 5000, engine ), b = big_random_bits( 64 * 4000, engine );
+    BigInt prime( "18446744073709551557" );
+    CHECK( a * b % prime == (a % prime) * (b % prime) % prime );
+    CHECK( (a * b) / b == a );
+}
+
+// Checks that divmod(n, d) gives q and r with q * d + r == n, |r| < |d| and r of the sign of n, as / and % do
+void check_division(const BigInt& n, const BigInt& d)
+{
+    auto [q, r] = divmod( n, d );
+    CHECK( q * d + r == n );
+    CHECK( abs( r ) < abs( d ) );
+    CHECK( r == 0 or (r < 0) == (n < 0) );
+    CHECK( n / d == q );
+    CHECK( n % d == r );
+}
+
+// Knuth's long division, on operands that make its quotient estimates go wrong as well as on random ones
+void test_long_division()
+{
+    BigInt top = pow( BigInt( 2 ), 64 * 4 ) - 1;
+    check_division( top, pow( BigInt( 2 ), 64 * 2 ) - 1 );
+    check_division( top, pow( BigInt( 2 ), 127 ) + 1 );
+    check_division( pow( BigInt( 2 ), 64 * 3 ), pow( BigInt( 2 ), 64 ) + 1 );
+    check_division( -top, 3 );
+    check_division( 7, -top );
+
+    bool thrown = false;
+    try
+    {
+        divmod( top, BigInt( 0 ) );
+    }
+    catch (const std::logic_error&)
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+
+    saved_thresholds saved;
+    big_int_thresholds.burnikel_ziegler = SIZE_MAX;
+    for (int i = 0; i < 100; ++i)
+    {
+        BigInt d = big_random_bits( 1 + engine() % 2000, engine ) + 1;
+        BigInt n = big_random_bits( engine() % 4000, engine );
+        check_division( i % 2 ? -n : n, i % 3 ? d : -d );
+    }
+}
+
+// Burnikel and Ziegler's recursive division keeps the identity at its smallest cutoff and at the default one, and
+// sqrt, which is seeded from it, rounds down
+void test_recursive_division()
+{
+    saved_thresholds saved;
+    for (size_t cutoff : { 4, 9, 32 })
+    {
+        big_int_thresholds.burnikel_ziegler = cutoff;
+        for (int i = 0; i < 30; ++i)
+        {
+            BigInt d = big_random_bits( 64 * cutoff + engine() % 6000, engine ) + 1;
+            BigInt n = big_random_bits( engine() % 16000, engine ) * (i % 2 ? -1 : 1);
+            check_division( n, d );
+            check_division( d * d - 1, d );
+        }
+    }
+
+    for (int i = 0; i < 30; ++i)
+    {
+        BigInt n = big_random_bits( engine() % 10000, engine );
+        BigInt root = sqrt( n );
+        CHECK( root * root <= n );
+        CHECK( (root + 1) * (root + 1) > n );
+    }
+    CHECK( sqrt( BigInt( 63 ) ) == 7 );
+}
+
+// Decimal strings convert to BigInts and back unchanged, through the divide-and-conquer paths as well
+void test_decimal_round_trip()
+{
+    saved_thresholds saved;
+    for (size_t cutoff : { 2, 5, 30 })
+    {
+        big_int_thresholds.radix_conversion = cutoff;
+        for (int i = 0; i < 20; ++i)
+        {
+            std::string digits = std::to_string( 1 + engine() % 9 );
+            for (size_t length = engine() % 3000; digits.size() < length;)
+            {
+                digits += std::to_string( engine() % 10 );
+            }
+            if (i % 4 == 0)
+            {
+                digits += std::string( engine() % 100, '0' );
+            }
+
+            big_int_thresholds.radix_conversion = SIZE_MAX;
+            BigInt expected( digits );
+            big_int_thresholds.radix_conversion = cutoff;
+            CHECK( BigInt( digits ) == expected );
+            CHECK( expected.to_string() == digits );
+            CHECK( BigInt( "-" + digits ).to_string() == "-" + digits );
+        }
+        CHECK( (pow( BigInt( 10 ), 2000 ) - 1).to_string() == std::string( 2000, '9' ) );
+        CHECK( pow( BigInt( 10 ), 1999 ).to_string() == "1" + std::string( 1999, '0' ) );
+    }
+}
+
+// Values of up to 128 bits are kept in the BigInt itself, and values that outgrow them move to the heap intact
+void test_inline_storage()
+{
+    bool inline_values_done = false, thrown = false;
+    try
+    {
+        // no buffer can be allocated in this scope
+        BigIntMemoryScope scope( std::pmr::null_memory_resource() );
+        BigInt a = LLONG_MAX, b = -3;
+        a *= a;
+        a -= a / 7 + b;
+        a %= BigInt( "100000000000000000000000000000000000000" );
+        CHECK( a.to_string() == "72917650054486813583483063815056429645" );
+        CHECK( (a << 1) >> 1 == a );
+        inline_values_done = true;
+        a <<= 100;
+    }
+    catch (const std::bad_alloc&)
+    {
+        thrown = true;
+    }
+    CHECK( inline_values_done );
+    CHECK( thrown );
+
+    BigInt value = pow( BigInt( 2 ), 127 );
+    value *= pow( BigInt( 2 ), 200 );
+    value /= pow( BigInt( 2 ), 200 );
+    CHECK( value == pow( BigInt( 2 ), 127 ) );
+    CHECK( value - 1 + 1 == value );
+}
+
+// A temporary on the left of + - * is updated and moved out, and gives the results of the copying operators
+void test_temporary_operands()
+{
+    for (int i = 0; i < 50; ++i)
+    {
+        BigInt a = big_random_bits( engine() % 2000, engine ) * (i % 2 ? -1 : 1);
+        BigInt b = big_random_bits( engine() % 2000, engine );
+        const BigInt& ca = a;
+        const BigInt& cb = b;
+        BigInt sum = ca + cb, difference = ca - cb, product = ca * cb;
+
+        CHECK( BigInt( a ) + b == sum );
+        CHECK( BigInt( a ) - b == difference );
+        CHECK( BigInt( a ) * b == product );
+        CHECK( BigInt( a ) * 1000000007 == ca * BigInt( 1000000007 ) );
+        CHECK( BigInt( a ) + "-123456789012345678901234567890" == ca - BigInt( "123456789012345678901234567890" ) );
+        CHECK( (a + b) * b - a == product + cb * cb - ca );
+        CHECK( a * 3 * -5 * 7 == ca * -105 );
+    }
+
+    // a moved-from BigInt is left as zero and can be assigned again
+    BigInt from = pow( BigInt( 10 ), 100 );
+    BigInt to = std::move( from );
+    CHECK( to == pow( BigInt( 10 ), 100 ) );
+    CHECK( from == 0 );
+    CHECK( from.to_string() == "0" );
+    from = -to;
+    CHECK( from + to == 0 );
+}
+
+// The operators with a long long operand give the results of the BigInt ones, LLONG_MIN included
+void test_word_operands()
+{
+    std::vector<long long> words = { 0, 1, -1, 7, -10, LLONG_MAX, LLONG_MIN, LLONG_MIN + 1 };
+    for (int i = 0; i < 8; ++i)
+    {
+        words.push_back( (long long) engine() );
+    }
+
+    std::vector<BigInt> values = { 0, 1, -1, BigInt( LLONG_MIN ), pow( BigInt( 2 ), 64 ), -pow( BigInt( 2 ), 64 ) };
+    for (int i = 0; i < 20; ++i)
+    {
+        values.push_back( big_random_bits( engine() % 700, engine ) * (i % 2 ? -1 : 1) );
+    }
+
+    for (const BigInt& a : values)
+    {
+        for (long long w : words)
+        {
+            BigInt b = w;
+            CHECK( a + w == a + b );
+            CHECK( w + a == b + a );
+            CHECK( a - w == a - b );
+            CHECK( w - a == b - a );
+            CHECK( a * w == a * b );
+            CHECK( w * a == b * a );
+            CHECK( (a < w) == (a < b) );
+            CHECK( (a == w) == (a == b) );
+            CHECK( (w > a) == (b > a) );
+            if (w != 0)
+            {
+                CHECK( a / w == a / b );
+                CHECK( a % w == a % b );
+            }
+            if (a != 0)
+            {
+                CHECK( w / a == b / a );
+                CHECK( w % a == b % a );
+            }
+
+            BigInt c = a;
+            c += w;
+            c -= w;
+            CHECK( c == a );
+            c *= w;
+            CHECK( c == a * b );
+            if (w != 0)
+            {
+                c /= w;
+                CHECK( c == a );
+                c %= w;
+                CHECK( c == a % b );
+            }
+        }
+    }
+}
+
+// The vector add and sub kernels give the carries and borrows of the scalar loops, on runs of all-ones and all-zero
+// limbs that carry across every lane
+void test_limb_kernels()
+{
+    std::vector<BigIntLimbKernels> kernels = { limb_kernels() };
+#ifdef BIG_INT_X86_KERNELS
+    if (__builtin_cpu_supports( "sse4.1" ))
+    {
+        kernels.push_back( { add_n_sse41, sub_n_sse41, "sse4.1" } );
+    }
+#endif
+
+    for (size_t n = 1; n <= 40; ++n)
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            std::vector<big_limb> a( n ), b( n ), expected( n ), result( n );
+            for (size_t j = 0; j < n; ++j)
+            {
+                // mostly limbs that pass a carry or a borrow on
+                int pattern = engine() % 4;
+                a[j] = pattern == 0 ? 0 : pattern == 1 ? ~big_limb( 0 ) : engine();
+                b[j] = engine() % 3 == 0 ? engine() : a[j] == 0 ? 0 : engine() % 2;
+            }
+            big_limb carry = engine() % 2;
+
+            for (const BigIntLimbKernels& kernel : kernels)
+            {
+                big_limb carry_out = add_n_scalar( expected.data(), a.data(), b.data(), n, carry );
+                CHECK( kernel.add_n( result.data(), a.data(), b.data(), n, carry ) == carry_out );
+                CHECK( result == expected );
+
+                carry_out = sub_n_scalar( expected.data(), a.data(), b.data(), n, carry );
+                CHECK( kernel.sub_n( result.data(), a.data(), b.data(), n, carry ) == carry_out );
+                CHECK( result == expected );
+
+                // in place, as += and -= use them
+                result = a;
+                CHECK( kernel.add_n( result.data(), result.data(), b.data(), n, carry ) ==
+                       add_n_scalar( expected.data(), a.data(), b.data(), n, carry ) );
+                CHECK( result == expected );
+            }
+        }
+    }
+
+    // a sum whose carry ripples through 40 limbs
+    BigInt power = pow( BigInt( 2 ), 64 * 40 );
+    for (size_t limbs = 8; limbs <= 40; ++limbs)
+    {
+        BigInt ones = pow( BigInt( 2 ), 64 * limbs ) - 1;
+        CHECK( ones + 1 == pow( BigInt( 2 ), 64 * limbs ) );
+        CHECK( power - ones - 1 == power - pow( BigInt( 2 ), 64 * limbs ) );
+    }
+}
+
+// Multiplications spread over several threads give the products of the calling thread alone, through both the
+// Toom-3 and the NTT split, and an exception thrown by a task reaches the caller
+void test_parallel_multiplication()
+{
+    saved_thresholds saved;
+    big_int_thresholds.parallel_mul = 8;
+    for (size_t ntt : { size_t( 40 ), SIZE_MAX })
+    {
+        big_int_thresholds.toom3 = 9;
+        big_int_thresholds.ntt = ntt;
+        for (int i = 0; i < 10; ++i)
+        {
+            BigInt a = big_random_bits( 64 * 20 + engine() % 6000, engine ) * (i % 2 ? -1 : 1);
+            BigInt b = big_random_bits( 64 * 20 + engine() % 6000, engine );
+
+            big_int_thresholds.mul_threads = 1;
+            BigInt product = a * b, square = a * a;
+            for (size_t threads : { 2, 3, 8 })
+            {
+                big_int_thresholds.mul_threads = threads;
+                CHECK( a * b == product );
+                CHECK( a * a == square );
+            }
+        }
+    }
+
+    bool thrown = false;
+    std::vector<std::function<void()>> tasks( 5, [] {} );
+    tasks[3] = [] { throw std::runtime_error( "task" ); };
+    try
+    {
+        run_parallel( tasks, 3 );
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+}
+
+// Checks that gcd(a, b) and gcd_extended(a, b) agree and give a common divisor, Bézout coefficients
+// a * x + b * y == g within |x| <= |b| and |y| <= |a|, and the lcm
+void check_gcd(const BigInt& a, const BigInt& b)
+{
+    BigInt g = gcd( a, b );
+    auto [g_extended, x, y] = gcd_extended( a, b );
+    CHECK( g_extended == g );
+    CHECK( a * x + b * y == g );
+    CHECK( g >= 0 );
+    if (g != 0)
+    {
+        CHECK( a % g == 0 );
+        CHECK( b % g == 0 );
+        CHECK( gcd( a / g, b / g ) == 1 );
+        CHECK( lcm( a, b ) * g == abs( a * b ) );
+    }
+    if (a != 0 and b != 0)
+    {
+        CHECK( abs( x ) <= abs( b ) );
+        CHECK( abs( y ) <= abs( a ) );
+    }
+}
+
+// Lehmer's GCD and gcd_extended keep their identities on random operands with a common factor, on consecutive
+// Fibonacci numbers, on quotients too large for a Lehmer step, and with zero or negative operands
+void test_gcd()
+{
+    for (int i = 0; i < 60; ++i)
+    {
+        BigInt common = big_random_bits( engine() % 500, engine ) + 1;
+        BigInt a = common * big_random_bits( engine() % 3000, engine );
+        BigInt b = common * big_random_bits( engine() % 3000, engine );
+        check_gcd( i % 2 ? -a : a, i % 3 ? b : -b );
+    }
+
+    BigInt f0 = 0, f1 = 1;
+    for (int i = 0; i < 3000; ++i)
+    {
+        f0 += f1;
+        std::swap( f0, f1 );
+    }
+    check_gcd( f1, f0 );
+
+    BigInt b = big_random_bits( 1000, engine ) + 1;
+    check_gcd( b * pow( BigInt( 2 ), 2000 ) + 1, b );
+    check_gcd( b, 0 );
+    check_gcd( 0, -b );
+    check_gcd( 0, 0 );
+    check_gcd( b, b );
+    CHECK( gcd( BigInt( 0 ), BigInt( 0 ) ) == 0 );
+    CHECK( gcd( BigInt( -12 ), 18 ) == 6 );
+    CHECK( lcm( BigInt( -4 ), 6 ) == 12 );
+}
+
+// Returns base^exp mod |mod| in [0, |mod|) by square-and-multiply with the % operator
+BigInt naive_powmod(const BigInt& base, BigInt exp, const BigInt& mod)
+{
+    BigInt m = abs( mod ), result = 1 % m, power = (base % m + m) % m;
+    for (; exp > 0; exp /= 2)
+    {
+        if (exp % 2 == 1)
+        {
+            result = result * power % m;
+        }
+        power = power * power % m;
+    }
+    return result;
+}
+
+// powmod and a reused BigIntMontgomery context give the powers of plain square-and-multiply with %, for odd and
+// even moduli, negative bases and the edge cases of the exponent and the modulus
+void test_powmod()
+{
+    for (int i = 0; i < 40; ++i)
+    {
+        BigInt mod = big_random_bits( 2 + engine() % 1200, engine ) + 2;
+        BigInt exp = big_random_bits( engine() % 300, engine );
+        BigInt base = big_random_bits( engine() % 1500, engine ) * (i % 3 ? 1 : -1);
+        CHECK( powmod( base, exp, mod ) == naive_powmod( base, exp, mod ) );
+        CHECK( powmod( base, exp, -mod ) == naive_powmod( base, exp, mod ) );
+
+        BigInt odd = mod % 2 == 1 ? mod : mod + 1;
+        BigIntMontgomery context( odd );
+        CHECK( context.modulus() == odd );
+        for (int j = 0; j < 3; ++j)
+        {
+            BigInt b = big_random_bits( engine() % 1500, engine ) * (j % 2 ? -1 : 1);
+            BigInt e = big_random_bits( engine() % 200, engine );
+            CHECK( context.pow( b, e ) == naive_powmod( b, e, odd ) );
+        }
+    }
+
+    // Fermat's little theorem for the Mersenne prime 2^521 - 1
+    BigInt prime = pow( BigInt( 2 ), 521 ) - 1;
+    CHECK( powmod( 3, prime - 1, prime ) == 1 );
+    CHECK( powmod( prime + 5, prime, prime ) == 5 );
+
+    CHECK( powmod( 5, 0, 7 ) == 1 );
+    CHECK( powmod( 5, 0, 8 ) == 1 );
+    CHECK( powmod( 5, 3, 1 ) == 0 );
+    CHECK( powmod( 5, 0, 1 ) == 0 );
+    CHECK( powmod( 0, 3, 8 ) == 0 );
+
+    int thrown = 0;
+    try
+    {
+        powmod( 2, -1, 7 );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown++;
+    }
+    try
+    {
+        powmod( 2, 5, 0 );
+    }
+    catch (const std::logic_error&)
+    {
+        thrown++;
+    }
+    try
+    {
+        BigIntMontgomery( BigInt( 10 ) );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown++;
+    }
+    CHECK( thrown == 3 );
+}
+
+// Squares, which every multiplication engine computes apart, equal the products by a copy held in other limbs
+void test_squaring()
+{
+    saved_thresholds saved;
+    for (size_t cutoff : { 2, 5, 12 })
+    {
+        big_int_thresholds.karatsuba = cutoff;
+        big_int_thresholds.toom3 = 3 * cutoff;
+        big_int_thresholds.ntt = 10 * cutoff;
+        for (int i = 0; i < 20; ++i)
+        {
+            BigInt a = big_random_bits( engine() % (64 * 30 * cutoff), engine ) * (i % 2 ? -1 : 1);
+            if (i % 5 == 0)
+            {
+                // all-ones limbs make the doubled cross products carry the furthest
+                a = pow( BigInt( 2 ), 64 * (1 + engine() % (20 * cutoff)) ) - 1;
+            }
+            BigInt copy = a, expected = a * copy;
+            CHECK( a * a == expected );
+            CHECK( a.square() == expected );
+            CHECK( expected >= 0 );
+            a *= a;
+            CHECK( a == expected );
+        }
+    }
+}
+
+// Product trees, on one thread or several, give the running products of their factors
+void test_product_trees()
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        std::vector<BigInt> factors;
+        BigInt expected = 1;
+        for (size_t n = engine() % 200; factors.size() < n;)
+        {
+            factors.push_back( big_random_bits( engine() % 500, engine ) * (engine() % 7 ? 1 : -1) );
+            expected *= factors.back();
+        }
+        CHECK( big_product( factors.begin(), factors.end() ) == expected );
+        CHECK( big_product( factors.begin(), factors.end(), 4 ) == expected );
+    }
+
+    std::vector<std::string> strings = { "123456789012345678901234567890", "-3", "18446744073709551616" };
+    CHECK( big_product( strings.begin(), strings.end() ) ==
+           BigInt( "-6832127373218094420745172514067685124034233630720" ) );
+
+    for (int i = 0; i < 20; ++i)
+    {
+        long long low = (long long) (engine() % 3000) - 1000, high = low + (long long) (engine() % 400) - 5;
+        if (i % 4 == 0)
+        {
+            low = 1 + engine() % 100;   // all factors positive
+        }
+        BigInt expected = 1;
+        for (long long factor = low; factor <= high; ++factor)
+        {
+            expected *= factor;
+        }
+        CHECK( big_range_product( low, high ) == expected );
+        CHECK( big_range_product( low, high, 3 ) == expected );
+    }
+    CHECK( big_range_product( 2, 20 ) == BigInt( "2432902008176640000" ) );
+    CHECK( big_range_product( -5, -1 ) == -120 );
+    CHECK( big_range_product( 5, 4 ) == 1 );
+}
+
+// Unsigned factors of 2^63 or more must not wrap around to negative numbers
+void test_big_product_unsigned()
+{
+    std::vector<unsigned long long> factors = { 18446744073709551615ULL, 2 };
+    CHECK( big_product( factors.begin(), factors.end() ) == BigInt( "36893488147419103230" ) );
+
+    std::vector<unsigned long long> high_bit = { 9223372036854775808ULL, 9223372036854775808ULL, 3 };
+    CHECK( big_product( high_bit.begin(), high_bit.end() ) == BigInt( "255211775190703847597530955573826158592" ) );
+
+    std::vector<long long> negative = { -3, 9223372036854775807LL };
+    CHECK( big_product( negative.begin(), negative.end() ) == BigInt( "-27670116110564327421" ) );
+}
+
+// Moving limbs in from another memory resource copies them, and a failed allocation must reach the caller
+void test_move_across_memory_resources()
+{
+    BigInt value = pow( BigInt( 10 ), 1000 );
+    big_limb buffer[4];
+    std::pmr::monotonic_buffer_resource arena( buffer, sizeof(buffer), std::pmr::null_memory_resource() );
+
+    bool thrown = false;
+    {
+        BigIntMemoryScope scope( &arena );
+        BigInt copy;
+        try
+        {
+            copy = std::move( value );
+        }
+        catch (const std::bad_alloc&)
+        {
+            thrown = true;
+        }
+    }
+    CHECK( thrown );
+    CHECK( value == pow( BigInt( 10 ), 1000 ) );
+}
+
+// BigInts written with to_bytes read back unchanged with from_bytes, also when several share a buffer
+void test_binary_encoding()
+{
+    std::vector<BigInt> values = { 0, 1, -1, 255, 256, -258, pow( BigInt( 2 ), 64 ) - 1, -pow( BigInt( 2 ), 64 ) };
+    for (int i = 0; i < 30; ++i)
+    {
+        values.push_back( big_random_bits( engine() % 3000, engine ) * (i % 2 ? -1 : 1) );
+    }
+
+    std::vector<std::byte> stream;
+    for (const BigInt& value : values)
+    {
+        std::vector<std::byte> buffer( value.byte_size() );
+        CHECK( value.to_bytes( buffer ) == buffer.size() );
+        CHECK( BigInt::byte_size( buffer ) == buffer.size() );
+        CHECK( BigInt::from_bytes( buffer ) == value );
+        stream.insert( stream.end(), buffer.begin(), buffer.end() );
+    }
+
+    // one value after another, with the rest of the stream after each of them
+    std::span<const std::byte> rest = stream;
+    for (const BigInt& value : values)
+    {
+        CHECK( BigInt::from_bytes( rest ) == value );
+        rest = rest.subspan( BigInt::byte_size( rest ) );
+    }
+    CHECK( rest.empty() );
+
+    // twice the length of the magnitude plus one for the sign, then the magnitude, little-endian
+    std::vector<std::byte> buffer( BigInt( -258 ).byte_size() );
+    BigInt( -258 ).to_bytes( buffer );
+    std::vector<std::byte> expected = { std::byte( 5 ), std::byte( 0 ), std::byte( 0 ), std::byte( 0 ),
+                                        std::byte( 0 ), std::byte( 0 ), std::byte( 0 ), std::byte( 0 ),
+                                        std::byte( 2 ), std::byte( 1 ) };
+    CHECK( buffer == expected );
+
+    int thrown = 0;
+    try
+    {
+        BigInt( -258 ).to_bytes( std::span( buffer ).first( 9 ) );
+    }
+    catch (const std::length_error&)
+    {
+        thrown++;
+    }
+    try
+    {
+        BigInt::from_bytes( std::span( buffer ).first( 9 ) );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown++;
+    }
+    try
+    {
+        BigInt::from_bytes( std::span( buffer ).first( 4 ) );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown++;
+    }
+    CHECK( thrown == 3 );
+}
+
+// big_pow10 gives the parsed powers of ten, from its compile-time table and past it
+void test_powers_of_ten()
+{
+    for (size_t exp : { 0, 1, 18, 19, 20, 38, 39, 40, 64, 1000, 5003 })
+    {
+        CHECK( big_pow10( exp ) == BigInt( "1" + std::string( exp, '0' ) ) );
+        CHECK( big_pow10( exp ).to_string().size() == exp + 1 );
+    }
+}
+
+// _big literals and BigIntConstants are worked out at compile time into the values the string constructor parses
+void test_compile_time_constants()
+{
+    CHECK( 123456789012345678901234567890_big == BigInt( "123456789012345678901234567890" ) );
+    CHECK( -123456789012345678901234567890_big == BigInt( "-123456789012345678901234567890" ) );
+    CHECK( 0xffff'ffff'ffff'ffff'ffff_big == BigInt( "1208925819614629174706175" ) );
+    CHECK( 01234567012345670123456701234567_big == BigInt( "1616895878810725189668911479" ) );
+    CHECK( 0b1011011101111011111011111101111111011111111011111111101111111111011111111111_big ==
+           BigInt( "54154956291645502388223" ) );
+    CHECK( 18446744073709551616_big == pow( BigInt( 2 ), 64 ) );
+    CHECK( 0_big == 0 );
+
+    constexpr auto largest = BigIntConstant<2>::from_string( "340282366920938463463374607431768211455" );
+    static_assert( largest.size == 2 and largest.limbs[0] == UINT64_MAX and largest.limbs[1] == UINT64_MAX );
+    constexpr auto negative = BigIntConstant<1>::from_string( "-0x8000'0000'0000'0000" );
+    static_assert( negative.negative and negative.limbs[0] == 1ULL << 63 );
+    constexpr auto zero = BigIntConstant<1>::from_string( "-0" );
+    static_assert( zero.size == 0 and not zero.negative );
+    constexpr BigIntConstant<1> minimum = LLONG_MIN;
+    CHECK( BigInt( largest ) == pow( BigInt( 2 ), 128 ) - 1 );
+    CHECK( BigInt( negative ) == -pow( BigInt( 2 ), 63 ) );
+    CHECK( BigInt( zero ).to_string() == "0" );
+    CHECK( BigInt( minimum ) == LLONG_MIN );
+
+    int thrown = 0;
+    try
+    {
+        BigIntConstant<1>::from_string( "18446744073709551616" );
+    }
+    catch (const std::overflow_error&)
+    {
+        thrown++;
+    }
+    try
+    {
+        BigIntConstant<1>::from_string( "0x12g4" );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown++;
+    }
+    CHECK( thrown == 2 );
+}
+
+// add_product and sub_product give x + a * b and x - a * b for every sign, with integer factors and with the
+// accumulator as one of the factors
+void test_fused_multiply_add()
+{
+    saved_thresholds saved;
+    big_int_thresholds.karatsuba = 4;
+    for (int i = 0; i < 60; ++i)
+    {
+        BigInt x = big_random_bits( engine() % 2500, engine ) * (i % 2 ? -1 : 1);
+        BigInt a = big_random_bits( engine() % 1500, engine ) * (i % 3 ? -1 : 1);
+        BigInt b = big_random_bits( engine() % 1500, engine ) * (i % 5 ? 1 : -1);
+        long long w = (long long) engine() >> (engine() % 64);
+
+        BigInt y = x;
+        CHECK( y.add_product( a, b ) == x + a * b );
+        CHECK( y.sub_product( a, b ) == x );
+        CHECK( y.sub_product( a, b ) == x - a * b );
+        y = x;
+        CHECK( y.add_product( a, w ) == x + a * w );
+        CHECK( y.sub_product( a, w ) == x );
+        CHECK( y.sub_product( a, LLONG_MIN ) == x - a * LLONG_MIN );
+
+        // results that cancel down to zero or change sign
+        y = a * b;
+        CHECK( y.sub_product( a, b ) == 0 );
+        y = a * b - 1;
+        CHECK( y.sub_product( a, b ) == -1 );
+
+        y = x;
+        CHECK( y.add_product( y, b ) == x + x * b );
+        y = x;
+        CHECK( y.sub_product( a, y ) == x - a * x );
+        y = x;
+        CHECK( y.add_product( y, y ) == x + x * x );
+    }
+}
+
+// The bitwise operators keep the identities of two's complement on negative numbers, match long long on words,
+// and the shifts multiply and divide rounding down
+void test_bitwise_operators()
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        BigInt a = big_random_bits( engine() % 1000, engine ) * (i % 2 ? -1 : 1);
+        BigInt b = big_random_bits( engine() % 1000, engine ) * (i % 4 < 2 ? -1 : 1);
+        if (i % 10 == 0)
+        {
+            b = -pow( BigInt( 2 ), 64 * (engine() % 4) );   // all ones below the lowest limb in use
+        }
+
+        CHECK( ~a == -a - 1 );
+        CHECK( ~~a == a );
+        CHECK( (a ^ b) == (a | b) - (a & b) );
+        CHECK( a + b == (a ^ b) + 2 * (a & b) );
+        CHECK( (a & b) == (b & a) );
+        CHECK( (a & ~a) == 0 );
+        CHECK( (a | ~a) == -1 );
+        CHECK( (a ^ a) == 0 );
+        CHECK( (a ^ -1) == ~a );
+        CHECK( ~(a & b) == (~a | ~b) );
+
+        BigInt c = a;
+        c &= b;
+        CHECK( c == (a & b) );
+        c = a;
+        c |= b;
+        CHECK( c == (a | b) );
+        c = a;
+        c ^= b;
+        CHECK( c == (a ^ b) );
+        c ^= c;
+        CHECK( c == 0 );
+
+        size_t shift = engine() % 300;
+        BigInt power = pow( BigInt( 2 ), shift );
+        BigInt quotient = a / power;
+        if (a % power < 0)
+        {
+            quotient -= 1;      // floor rather than truncation
+        }
+        CHECK( (a << shift) == a * power );
+        CHECK( (a >> shift) == quotient );
+        c = a;
+        c <<= shift;
+        c >>= shift;
+        CHECK( c == a );
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        long long x = (long long) engine(), y = (long long) engine() >> (engine() % 64);
+        unsigned shift = engine() % 63;
+        CHECK( (BigInt( x ) & BigInt( y )) == (x & y) );
+        CHECK( (BigInt( x ) | BigInt( y )) == (x | y) );
+        CHECK( (BigInt( x ) ^ BigInt( y )) == (x ^ y) );
+        CHECK( ~BigInt( x ) == ~x );
+        CHECK( (BigInt( x ) >> shift) == (x >> shift) );
+    }
+
+    BigInt value = -pow( BigInt( 2 ), 100 ) * 12;
+    CHECK( value.bit_length() == 104 );
+    CHECK( value.popcount() == 2 );
+    CHECK( value.countr_zero() == 102 );
+    CHECK( BigInt( 0 ).bit_length() == 0 );
+    CHECK( (BigInt( -1 ) >> 1000) == -1 );
+    CHECK( (BigInt( 1 ) >> 1000) == 0 );
+}
+
+// Random BigInts stay inside their bounds, reach both ends of a small range, and have the digits asked for
+void test_random_numbers()
+{
+    for (int i = 0; i < 50; ++i)
+    {
+        BigInt low = big_random_bits( engine() % 500, engine ) * (i % 2 ? -1 : 1);
+        BigInt high = low + big_random_bits( engine() % 500, engine );
+        for (int j = 0; j < 10; ++j)
+        {
+            BigInt value = big_random_range( low, high, engine );
+            CHECK( value >= low );
+            CHECK( value <= high );
+        }
+        CHECK( big_random_range( high, high, engine ) == high );
+
+        size_t bits = engine() % 300;
+        BigInt value = big_random_bits( bits, engine );
+        CHECK( value >= 0 );
+        CHECK( value.bit_length() <= bits );
+    }
+
+    bool seen[5] = {};
+    for (int i = 0; i < 200; ++i)
+    {
+        BigInt value = big_random_range( -2, 2, engine );
+        CHECK( value >= -2 and value <= 2 );
+        seen[value.to_long_long() + 2] = true;
+    }
+    CHECK( seen[0] and seen[1] and seen[2] and seen[3] and seen[4] );
+
+    for (size_t digits : { 1, 19, 20, 39, 500 })
+    {
+        CHECK( big_random( digits, engine ).to_string().size() == digits );
+        CHECK( big_random( digits ).to_string().size() == digits );
+    }
+    size_t length = big_random( 0, engine ).to_string().size();
+    CHECK( length >= 1 and length <= MAX_RANDOM_LENGTH );
+
+    bool thrown = false;
+    try
+    {
+        big_random_range( 1, 0, engine );
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+}
+
+// A placeholder with an empty spec must not take the '<', '>' or '^' that follows it for an alignment
+void test_format_empty_spec()
+{
+#ifdef __cpp_lib_format
+    BigInt value( -12345 );
+    CHECK( std::format( "<{}>", value ) == "<-12345>" );
+    CHECK( std::format( "{}^{}", value, 1 ) == "-12345^1" );
+    CHECK( std::format( "{}<{:>8}>", value, value ) == "-12345<  -12345>" );
+#endif
+}
+
+// Braces as the fill character and nested replacement fields for the width are rejected
+void test_format_invalid_spec()
+{
+#ifdef __cpp_lib_format
+    BigInt value( 12345 );
+    for (const char* spec : { "{:{<8}", "{:{}}", "{:>{}}", "{:0{}}" })
+    {
+        bool thrown = false;
+        try
+        {
+            std::vformat( spec, std::make_format_args( value ) );
+        }
+        catch (const std::format_error&)
+        {
+            thrown = true;
+        }
+        CHECK( thrown );
+    }
+    CHECK( std::vformat( "{:*<8}", std::make_format_args( value ) ) == "12345***" );
+#endif
+}
+
+// Returns the digits of |num| in `base`, worked out one at a time with divmod
+std::string reference_digits(BigInt num, int base)
+{
+    std::string digits;
+    num = abs( num );
+    do
+    {
+        auto [quotient, remainder] = divmod( num, BigInt( base ) );
+        digits.insert( digits.begin(), "0123456789abcdef"[remainder.to_int()] );
+        num = quotient;
+    } while (num != 0);
+    return digits;
+}
+
+// write_digits, behind both operator<< and std::formatter, announces the exact number of digits once and then
+// writes them in every base, in blocks of at most 64
+void test_write_digits()
+{
+    saved_thresholds saved;
+    big_int_thresholds.radix_conversion = 3;
+    std::vector<BigInt> values = { 0, 1, -1, 7, -8, 255, pow( BigInt( 10 ), 19 ), pow( BigInt( 10 ), 19 ) - 1,
+                                   pow( BigInt( 2 ), 64 ), pow( BigInt( 2 ), 64 ) - 1, -pow( BigInt( 2 ), 192 ) };
+    for (int i = 0; i < 20; ++i)
+    {
+        values.push_back( big_random_bits( engine() % 2500, engine ) * (i % 2 ? -1 : 1) );
+    }
+
+    for (const BigInt& value : values)
+    {
+        for (int base : { 2, 8, 10, 16 })
+        {
+            std::string digits;
+            size_t announced = 0, starts = 0;
+            bool blocks_fit = true, started_first = true;
+            write_digits( value, base, false,
+                          [&]( size_t count ) { announced = count; starts++; },
+                          [&]( const char* block, size_t count ) {
+                              started_first = started_first and starts == 1;
+                              blocks_fit = blocks_fit and count > 0 and count <= 64;
+                              digits.append( block, count );
+                          } );
+            CHECK( digits == reference_digits( value, base ) );
+            CHECK( announced == digits.size() );
+            CHECK( starts == 1 );
+            CHECK( started_first );
+            CHECK( blocks_fit );
+        }
+    }
+
+    std::string upper;
+    write_digits( BigInt( -0xabcdef ), 16, true, []( size_t ) {},
+                  [&]( const char* block, size_t count ) { upper.append( block, count ); } );
+    CHECK( upper == "ABCDEF" );
+}
+
+// The digits are written to the stream in blocks, with the padding on the side set by the stream
+void test_stream_output()
+{
+    std::ostringstream out;
+    out << std::setfill( '.' ) << std::left << std::setw( 8 ) << BigInt( 255 ) << '|'
+        << std::internal << std::showbase << std::hex << std::setw( 8 ) << BigInt( -255 ) << '|'
+        << std::right << std::setw( 3 ) << BigInt( 0 );
+    CHECK( out.str() == "255.....|-0x...ff|..0" );
+
+    std::ostringstream nines;
+    nines << pow( BigInt( 10 ), 5000 ) - 1;
+    CHECK( nines.str() == std::string( 5000, '9' ) );
+}
+
+// Inputs of more than twice the limbs of the modulus are reduced in place, a window at a time
+void test_barrett_long_inputs()
+{
+    for (BigInt modulus : { BigInt( 3 ), pow( BigInt( 2 ), 64 ), pow( BigInt( 10 ), 100 ) + 7, pow( BigInt( 7 ), 900 ) })
+    {
+        BigIntBarrett barrett( modulus );
+        for (BigInt value : { pow( BigInt( 3 ), 5000 ), -pow( BigInt( 10 ), 3000 ) - 1, modulus * modulus * modulus })
+        {
+            BigInt expected = value % modulus;
+            if (expected < 0)
+            {
+                expected += modulus;
+            }
+            CHECK( barrett.reduce( value ) == expected );
+        }
+    }
+}
+
+// Returns num mod |mod| in [0, |mod|) with the % operator
+BigInt naive_mod(const BigInt& num, const BigInt& mod)
+{
+    BigInt remainder = num % mod;
+    return remainder < 0 ? remainder + abs( mod ) : remainder;
+}
+
+// A Barrett context reduces, multiplies and adds as % does, for inputs of every length and sign and for moduli of
+// one limb, of whole limbs and of a single bit over them
+void test_barrett_reduction()
+{
+    BigInt limbs = pow( BigInt( 2 ), 128 );
+    std::vector<BigInt> moduli = { 1, 2, -3, pow( BigInt( 2 ), 64 ) - 1, limbs, limbs + 1 };
+    for (int i = 0; i < 20; ++i)
+    {
+        moduli.push_back( (big_random_bits( engine() % 2000, engine ) + 1) * (i % 2 ? -1 : 1) );
+    }
+
+    for (const BigInt& modulus : moduli)
+    {
+        BigIntBarrett barrett( modulus );
+        CHECK( barrett.modulus() == abs( modulus ) );
+        size_t bits = modulus.bit_length();
+        for (int i = 0; i < 10; ++i)
+        {
+            BigInt a = big_random_bits( engine() % (3 * bits + 100), engine ) * (i % 2 ? -1 : 1);
+            BigInt b = big_random_bits( engine() % (2 * bits + 100), engine ) * (i % 3 ? 1 : -1);
+            CHECK( barrett.reduce( a ) == naive_mod( a, modulus ) );
+            CHECK( barrett.mulmod( a, b ) == naive_mod( a * b, modulus ) );
+            CHECK( barrett.addmod( a, b ) == naive_mod( a + b, modulus ) );
+
+            // reduced operands, and sums that land on the modulus itself
+            BigInt x = naive_mod( a, modulus ), y = naive_mod( b, modulus );
+            CHECK( barrett.mulmod( x, y ) == naive_mod( x * y, modulus ) );
+            CHECK( barrett.addmod( x, abs( modulus ) - x ) == 0 );
+        }
+    }
+
+    bool thrown = false;
+    try
+    {
+        BigIntBarrett( BigInt( 0 ) );
+    }
+    catch (const std::logic_error&)
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+}
+
+int main()
+{
+    test_limb_storage();
+    test_addition_and_subtraction();
+    test_multiplication_engines();
+    test_ntt_multiplication();
+    test_long_division();
+    test_recursive_division();
+    test_decimal_round_trip();
+    test_inline_storage();
+    test_temporary_operands();
+    test_word_operands();
+    test_limb_kernels();
+    test_parallel_multiplication();
+    test_gcd();
+    test_powmod();
+    test_squaring();
+    test_product_trees();
+    test_big_product_unsigned();
+    test_move_across_memory_resources();
+    test_binary_encoding();
+    test_powers_of_ten();
+    test_compile_time_constants();
+    test_fused_multiply_add();
+    test_bitwise_operators();
+    test_random_numbers();
+    test_format_empty_spec();
+    test_format_invalid_spec();
+    test_write_digits();
+    test_stream_output();
+    test_barrett_long_inputs();
+    test_barrett_reduction();
+
+    if (failures)
+    {
+        std::cerr << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -85,7 +85,7 @@ int main()
     // Combinar ambos resultados parciales en el factorial final.
     auto result = *thread1_result * *thread2_result;
 
-    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number.to_string(), result.to_string() );
+    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number, result );
 
     return EXIT_SUCCESS;
 }
@@ -12,8 +12,6 @@
 
 #include <cerrno>
 #include <cstring>
-#include <functional>
-#include <numeric>
 #include <print>
 #include <vector>
 
@@ -44,7 +42,7 @@ void* factorial_thread (void* arg)
 
     // Bloquear el mutex y guardar el resultado
     pthread_mutex_lock( &args->results->mutex );
-    args->results->partials.push_back( result );
+    args->results->partials.push_back( std::move(result) );
     pthread_mutex_unlock( &args->results->mutex );
 
     return nullptr;
@@ -97,10 +95,9 @@ int main()
     pthread_join( thread2, nullptr ); 
 
     // Combinar ambos resultados parciales en el factorial final.
-    auto result = std::reduce( thread_results.partials.begin(), thread_results.partials.end(),
-        BigInt{1}, std::multiplies<BigInt>() );
+    auto result = big_product( thread_results.partials.begin(), thread_results.partials.end() );
 
-    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number.to_string(), result.to_string() );
+    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number, result );
 
     pthread_mutex_destroy( &thread_results.mutex);
 
@@ -10,9 +10,7 @@
 //      g++ -I../ -I../../lib -o threads-sync-factorial threads-sync-factorial.cpp
 //
 
-#include <functional>
 #include <mutex>
-#include <numeric>
 #include <print>
 #include <sstream>      // Requerido para la conversion de std::thread::id
 #include <thread>
@@ -33,7 +31,7 @@ void factorial_thread (factorial_thread_results& results, BigInt number, BigInt
 
     // Bloquear el mutex y guardar el resultado
     std::lock_guard<std::mutex> lock( results.mutex );
-    results.partials.push_back( result );
+    results.partials.push_back( std::move(result) );
     // El mutex se desbloquea al destruirse 'lock'
 }
 
@@ -61,10 +59,9 @@ int main()
     thread2.join(); 
 
     // Combinar ambos resultados parciales en el factorial final.
-    auto result = std::reduce( thread_results.partials.begin(), thread_results.partials.end(),
-        BigInt{1}, std::multiplies<BigInt>() );
+    auto result = big_product( thread_results.partials.begin(), thread_results.partials.end() );
 
-    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number.to_string(), result.to_string() );
+    std::println( "[HILO PRINCIPAL] El factorial de {} es {}", number, result );
 
     return EXIT_SUCCESS;
 }
@@ -31,19 +31,15 @@ BigInt calculate_factorial(BigInt number, BigInt lower_bound, std::string_view o
 
     std::println( "Calculando..." );
 
+    // Multiplicar los factores por parejas, en un árbol equilibrado, es mucho más rápido que ir multiplicando
+    // un acumulador cada vez más grande por cada factor.
     lower_bound = lower_bound < 2 ? 2 : lower_bound;
-    BigInt factorial = 1;
-    for ( BigInt i = lower_bound; i <= number; i++ )
-    {
-        factorial = factorial * i;
-    }
-
-    return factorial;
+    return big_range_product( lower_bound, number );
 }
 
 BigInt calculate_factorial(BigInt number, std::string_view output_label = "FACTORIAL")
 {
-    return calculate_factorial(number, 2, output_label);
+    return calculate_factorial(std::move(number), 2, output_label);
 }
 
 BigInt cancellable_calculate_factorial(std::stop_token stoken, BigInt number, BigInt lower_bound,
@@ -64,7 +60,7 @@ BigInt cancellable_calculate_factorial(std::stop_token stoken, BigInt number, Bi
         {
             return factorial;
         }
-        factorial = factorial * i;
+        factorial *= i;
     }
 
     return factorial;